@@ -17,6 +17,8 @@ class CubeSatDataDiscriminators
         static constexpr char MODULE_DISCRIMINATOR = ';';
         static constexpr char DEVICE_DISCRIMINATOR = ':';
         static constexpr char DATUM_DISCRIMINATOR = ',';
+        static constexpr char TRACE_DISCRIMINATOR = '@';
+        static constexpr char HUB_TRACE_DISCRIMINATOR = '/';
 };
 
 #endif
\ No newline at end of file
@@ -15,9 +15,19 @@
                               device is online.
         dataStream: string  - Stream of data output by the device in a comma-
                               separated string.
+        filterStage:
+            CubeSatFilterStage* - Optional filtering applied to the device's
+                                  fields between sampling and encoding.
     Methods:
         refreshDataStream:
             Refreshes the datastream with new readings from the device.
+        sampleIfDue:
+            Feeds a sample into the filter stage if the sample interval
+            has elapsed.
+        getNextSampleTime:
+            Gets the time the filter stage is next due a sample.
+        formatFields:
+            Encodes numeric fields as a comma-separated string.
 ******************************************************************************/
 
 #include "CubeSatDevice.h"
@@ -31,20 +41,108 @@ CubeSatDevice::CubeSatDevice(int deviceId, const char* deviceType)
     this->status = true;
 };
 
+// Destructor
+CubeSatDevice::~CubeSatDevice()
+{
+    delete this->filterStage;
+}
+
 // Set device status
 void CubeSatDevice::setStatus(bool status)
 {
     this->status = status;
 }
 
+// Set the filter stage. The device owns the filter stage.
+void CubeSatDevice::setFilterStage(CubeSatFilterStage* filterStage)
+{
+    delete this->filterStage;
+    this->filterStage = filterStage;
+}
+
+// Set the filter stage sample interval
+void CubeSatDevice::setSampleInterval(unsigned long sampleInterval)
+{
+    this->sampleInterval = sampleInterval;
+}
+
+// Set the capture time of the latest reading
+void CubeSatDevice::setCaptureTime(uint32_t captureTime)
+{
+    this->captureTime = captureTime;
+}
+
 // Update the data stream
 void CubeSatDevice::refreshDataStream() 
 { 
+    if (this->filterStage)
+    {
+        // Emit the latest filtered fields instead of a fresh reading.
+        double fields[CubeSatFilterStage::MAX_FIELDS];
+        size_t count = this->filterStage->readOutputs(fields);
+        if (count > 0)
+        {
+            this->dataStream = formatFields(fields, count) + CubeSatDataDiscriminators::DEVICE_DISCRIMINATOR;
+            return;
+        }
+    }
     this->dataStream = this->readSensor() += CubeSatDataDiscriminators::DEVICE_DISCRIMINATOR;
 };
 
+// Feed a sample into the filter stage if the sample interval has elapsed
+bool CubeSatDevice::sampleIfDue(unsigned long now)
+{
+    unsigned long lag = now - this->lastSampleTime;
+    if (!this->filterStage || lag < this->sampleInterval)
+    {
+        return false;
+    }
+
+    // Keep to the schedule rather than the wake time, so late wakeups do
+    // not shift samples against refreshes. Samples missed entirely are
+    // skipped.
+    this->lastSampleTime = now - lag % this->sampleInterval;
+
+    double fields[CubeSatFilterStage::MAX_FIELDS];
+    size_t count = this->sampleFields(fields);
+    if (count > 0)
+    {
+        this->filterStage->addSample(fields, count);
+    }
+    return true;
+}
+
+// Get the time the filter stage is next due a sample
+bool CubeSatDevice::getNextSampleTime(unsigned long& nextSampleTime)
+{
+    if (!this->filterStage)
+    {
+        return false;
+    }
+    nextSampleTime = this->lastSampleTime + this->sampleInterval;
+    return true;
+}
+
+// Encode numeric fields as a comma-separated string
+std::string CubeSatDevice::formatFields(const double* fields, size_t count)
+{
+    std::string encoded = "";
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i > 0)
+        {
+            encoded += CubeSatDataDiscriminators::DATUM_DISCRIMINATOR;
+        }
+        encoded += std::to_string(fields[i]);
+    }
+    return encoded;
+}
+
 // getters
 int CubeSatDevice::getDeviceId() { return this->deviceId; };
 bool CubeSatDevice::getStatus() { return this->status; };
 std::string CubeSatDevice::getDataStream() { return this->dataStream; };
+CubeSatFilterStage* CubeSatDevice::getFilterStage() { return this->filterStage; };
+unsigned long CubeSatDevice::getSampleInterval() { return this->sampleInterval; };
+uint32_t CubeSatDevice::getCaptureTime() { return this->captureTime; };
 
@@ -15,26 +15,53 @@
                               device is online.
         dataStream: string  - Stream of data output by the device in a comma-
                               separated string.
+        filterStage:
+            CubeSatFilterStage* - Optional filtering applied to the device's
+                                  fields between sampling and encoding.
+        sampleInterval:
+            unsigned long       - Milliseconds between filter stage samples.
+        lastSampleTime:
+            unsigned long       - Scheduled time of the most recent filter
+                                  stage sample.
+        captureTime:
+            uint32_t            - Clock time, in microseconds, at which the
+                                  reading in the data stream was captured.
     Methods:
         initializeDevice:
             Virtual method to set up the device for reading data.
         readSensor:
             Virtual method to read data from the device.
+        sampleFields:
+            Virtual method to read the device's numeric fields. Required
+            for the device to be filtered.
         refreshDataStream:
             Refreshes the datastream with new readings from the device
-            using the readSensor function.
+            using the readSensor function, or with the latest filtered
+            fields if the device has a filter stage.
+        sampleIfDue:
+            Feeds a sample into the filter stage if the sample interval
+            has elapsed.
+        getNextSampleTime:
+            Gets the time the filter stage is next due a sample.
+        formatFields:
+            Encodes numeric fields as a comma-separated string.
 ******************************************************************************/
 
 #ifndef CUBESAT_DEVICE_H
 #define CUBESAT_DEVICE_H
 
+#include <cstdint>
 #include <string>
+#include "Filters/CubeSatFilterStage.h"
 
 class CubeSatDevice
 {
     public:
+        static constexpr unsigned long DEFAULT_SAMPLE_INTERVAL_MS = 100;
+
         // Constructor
         CubeSatDevice(int deviceId, const char* deviceType);
+        virtual ~CubeSatDevice();
 
         // Virtual function to initialize a device.
         virtual void initializeDevice(void* config) = 0;
@@ -42,23 +69,50 @@ class CubeSatDevice
         // Virtual function to read a sensor device.
         virtual std::string readSensor() = 0;
 
+        // Virtual function to read a device's numeric fields into fields,
+        // which has room for CubeSatFilterStage::MAX_FIELDS values.
+        // Returns the number of fields read.
+        virtual size_t sampleFields(double*) { return 0; }
+
         // Update the data stream
         void refreshDataStream();
+
+        // Feed a sample into the filter stage if the sample interval
+        // has elapsed since the last one. Returns true if sampled.
+        bool sampleIfDue(unsigned long now);
+
+        // Get the time the filter stage is next due a sample. Returns
+        // false if the device is not filtered.
+        bool getNextSampleTime(unsigned long& nextSampleTime);
         
         // Getters
         int getDeviceId();
         int getDeviceType();
         bool getStatus();
         std::string getDataStream();
+        CubeSatFilterStage* getFilterStage();
+        unsigned long getSampleInterval();
+        uint32_t getCaptureTime();
 
         // Setters
         void setStatus(bool status);
+        void setFilterStage(CubeSatFilterStage* filterStage);
+        void setSampleInterval(unsigned long sampleInterval);
+        void setCaptureTime(uint32_t captureTime);
+
+    protected:
+        // Encodes numeric fields as a comma-separated string.
+        static std::string formatFields(const double* fields, size_t count);
 
     private:
         int deviceId;
         const char* deviceType;
         bool status = 0;
         std::string dataStream = "";
+        CubeSatFilterStage* filterStage = nullptr;
+        unsigned long sampleInterval = DEFAULT_SAMPLE_INTERVAL_MS;
+        unsigned long lastSampleTime = 0;
+        uint32_t captureTime = 0;
 };
 
 #endif
\ No newline at end of file
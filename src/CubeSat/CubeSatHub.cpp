@@ -3,9 +3,167 @@
 /******************************************************************************
     CubeSatHub Class Implementation
 
-    Purpose: 
-        CubeSat subclass. Represents a CubeSat device acting as the hub. 
-        A CubeSat hub should receive data from other CubeSat devices and 
+    Purpose:
+        CubeSat subclass. Represents a CubeSat device acting as the hub.
+        A CubeSat hub should receive data from other CubeSat devices and
         send data, including its own, to the ground-station transmission medium.
+    Methods:
+        ingestDataStream:
+            Accepts a module data stream for downlink, stamping its ingest
+            time and updating the sending module's clock estimate.
+        takeDownlinkDataStreams:
+            Stamps and returns the pending data streams for transmission.
+        getLatencyStats:
+            Returns the rolling latency statistics of a module's stage.
+        getClockSync:
+            Returns the clock estimate of a module.
+        getLatencyReport:
+            Summarizes every module's latency statistics, one line per
+            module and stage.
 ******************************************************************************/
 
+#include <algorithm>
+#include <cstdlib>
+#include "CubeSatHub.h"
+#include "CubeSatDataDiscriminators.h"
+
+// Accepts a module data stream for downlink.
+bool CubeSatHub::ingestDataStream(const std::string& dataStream)
+{
+    // Data streams begin with the sending module's ID.
+    size_t idEnd = dataStream.find(CubeSatDataDiscriminators::DEVICE_DISCRIMINATOR);
+    if (idEnd == 0 || idEnd == std::string::npos
+        || dataStream.find_first_not_of("0123456789") < idEnd)
+    {
+        return false;
+    }
+
+    PendingDataStream pending;
+    pending.dataStream = dataStream;
+    pending.moduleId = std::atoi(dataStream.substr(0, idEnd).c_str());
+    pending.ingestTime = getClock() ? getClock()->micros() : 0;
+    pending.isTraced = getClock() && CubeSatFrameTrace::parse(dataStream, pending.trace);
+
+    if (pending.isTraced)
+    {
+        ModuleLatency& latency = moduleLatencies[pending.moduleId];
+
+        // The hub's own data streams are already on the hub's clock.
+        uint32_t encodeTime = pending.trace.encodeTime;
+        if (pending.moduleId != getModuleId())
+        {
+            latency.clockSync.observe(encodeTime, pending.ingestTime);
+            encodeTime = latency.clockSync.toHubTime(encodeTime);
+        }
+
+        int32_t ingestDelay = static_cast<int32_t>(pending.ingestTime - encodeTime);
+        pending.trace.ingestDelay = ingestDelay < 0 ? 0 : ingestDelay;
+
+        for (uint32_t captureAge : pending.trace.captureAges)
+        {
+            latency.stages[CAPTURE_TO_ENCODE].record(captureAge);
+        }
+        latency.stages[ENCODE_TO_INGEST].record(pending.trace.ingestDelay);
+    }
+
+    if (pendingDataStreams.size() >= MAX_PENDING_DATA_STREAMS)
+    {
+        pendingDataStreams.erase(pendingDataStreams.begin());
+    }
+    pendingDataStreams.push_back(pending);
+    return true;
+}
+
+// Stamps the pending data streams with their hub latencies and returns
+// them for transmission.
+std::vector<std::string> CubeSatHub::takeDownlinkDataStreams()
+{
+    uint32_t transmitTime = getClock() ? getClock()->micros() : 0;
+
+    std::vector<std::string> dataStreams;
+    for (PendingDataStream& pending : pendingDataStreams)
+    {
+        if (!pending.isTraced)
+        {
+            dataStreams.push_back(pending.dataStream);
+            continue;
+        }
+
+        CubeSatFrameTrace& trace = pending.trace;
+        trace.hasHubStages = true;
+        trace.transmitDelay = transmitTime - pending.ingestTime;
+
+        ModuleLatency& latency = moduleLatencies[pending.moduleId];
+        uint32_t captureAge = 0;
+        if (!trace.captureAges.empty())
+        {
+            captureAge = *std::max_element(trace.captureAges.begin(), trace.captureAges.end());
+        }
+        latency.stages[INGEST_TO_TRANSMIT].record(trace.transmitDelay);
+        latency.stages[CAPTURE_TO_TRANSMIT].record(captureAge + trace.ingestDelay + trace.transmitDelay);
+
+        // Replace the module's trace with one carrying the hub stages.
+        std::string dataStream = pending.dataStream.substr(0, CubeSatFrameTrace::find(pending.dataStream));
+        dataStreams.push_back(dataStream + trace.encode() + CubeSatDataDiscriminators::MODULE_DISCRIMINATOR);
+    }
+
+    pendingDataStreams.clear();
+    return dataStreams;
+}
+
+// Returns the rolling latency statistics of a module's stage.
+CubeSatLatencyStats* CubeSatHub::getLatencyStats(int moduleId, LatencyStage stage)
+{
+    std::map<int, ModuleLatency>::iterator latency = moduleLatencies.find(moduleId);
+    if (latency == moduleLatencies.end() || stage >= LATENCY_STAGE_COUNT)
+    {
+        return nullptr;
+    }
+    return &latency->second.stages[stage];
+}
+
+// Returns the clock estimate of a module.
+CubeSatClockSync* CubeSatHub::getClockSync(int moduleId)
+{
+    std::map<int, ModuleLatency>::iterator latency = moduleLatencies.find(moduleId);
+    if (latency == moduleLatencies.end())
+    {
+        return nullptr;
+    }
+    return &latency->second.clockSync;
+}
+
+// Summarizes every module's latency statistics, one line per module and
+// stage.
+std::vector<std::string> CubeSatHub::getLatencyReport()
+{
+    std::vector<std::string> report;
+    for (std::pair<const int, ModuleLatency>& latency : moduleLatencies)
+    {
+        for (int stage = 0; stage < LATENCY_STAGE_COUNT; stage++)
+        {
+            report.push_back(std::string("LATENCY,") + std::to_string(latency.first)
+                + "," + getLatencyStageName(static_cast<LatencyStage>(stage))
+                + "," + latency.second.stages[stage].formatSummary());
+        }
+    }
+    return report;
+}
+
+// Returns the name of a stage as used in the latency report.
+const char* CubeSatHub::getLatencyStageName(LatencyStage stage)
+{
+    switch (stage)
+    {
+        case CAPTURE_TO_ENCODE:
+            return "capture_to_encode";
+        case ENCODE_TO_INGEST:
+            return "encode_to_ingest";
+        case INGEST_TO_TRANSMIT:
+            return "ingest_to_transmit";
+        case CAPTURE_TO_TRANSMIT:
+            return "capture_to_transmit";
+        default:
+            return "unknown";
+    }
+}
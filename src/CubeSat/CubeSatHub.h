@@ -3,24 +3,106 @@
 /******************************************************************************
     CubeSatHub Class Header
 
-    Purpose: 
-        CubeSat subclass. Represents a CubeSat device acting as the hub. 
-        A CubeSat hub should receive data from other CubeSat devices and 
+    Purpose:
+        CubeSat subclass. Represents a CubeSat device acting as the hub.
+        A CubeSat hub should receive data from other CubeSat devices and
         send data, including its own, to the ground-station transmission medium.
+    Attributes:
+        pendingDataStreams: vector<PendingDataStream> - Data streams ingested
+                                                        but not yet sent down.
+        moduleLatencies:    map<int, ModuleLatency>   - Clock synchronization
+                                                        and rolling latency
+                                                        statistics per module.
+    Methods:
+        ingestDataStream:
+            Accepts a module data stream for downlink, stamping its ingest
+            time and updating the sending module's clock estimate.
+        takeDownlinkDataStreams:
+            Stamps and returns the pending data streams for transmission.
+        getLatencyStats:
+            Returns the rolling latency statistics of a module's stage.
+        getClockSync:
+            Returns the clock estimate of a module.
+        getLatencyReport:
+            Summarizes every module's latency statistics, one line per
+            module and stage.
 ******************************************************************************/
 
 #ifndef CUBESAT_HUB_H
 #define CUBESAT_HUB_H
 
 #include "CubeSatModule.h"
+#include "Timing/CubeSatClockSync.h"
+#include "Timing/CubeSatFrameTrace.h"
+#include "Timing/CubeSatLatencyStats.h"
+#include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 class CubeSatHub : public CubeSatModule
 {
     public:
+        // Pipeline stages with rolling latency statistics.
+        enum LatencyStage
+        {
+            CAPTURE_TO_ENCODE,
+            ENCODE_TO_INGEST,
+            INGEST_TO_TRANSMIT,
+            CAPTURE_TO_TRANSMIT,
+            LATENCY_STAGE_COUNT
+        };
+
+        // Data streams held for downlink before the oldest are dropped.
+        static constexpr size_t MAX_PENDING_DATA_STREAMS = 32;
+
         CubeSatHub(int id, std::vector<CubeSatDevice*> devices)
         : CubeSatModule(true, id, devices) {}
+
+        // Accepts a module data stream for downlink, stamping its ingest
+        // time and updating the sending module's clock estimate. Returns
+        // false if the data stream has no module ID.
+        bool ingestDataStream(const std::string& dataStream);
+
+        // Stamps the pending data streams with their hub latencies and
+        // returns them for transmission.
+        std::vector<std::string> takeDownlinkDataStreams();
+
+        // Returns the rolling latency statistics of a module's stage, or
+        // nullptr if the module has not sent a traced data stream.
+        CubeSatLatencyStats* getLatencyStats(int moduleId, LatencyStage stage);
+
+        // Returns the clock estimate of a module, or nullptr if the module
+        // has not sent a traced data stream.
+        CubeSatClockSync* getClockSync(int moduleId);
+
+        // Summarizes every module's latency statistics, one line per
+        // module and stage:
+        //     LATENCY,<moduleId>,<stage>,<count>,<p50>,<p90>,<p99>,<max>
+        // Latencies are in microseconds.
+        std::vector<std::string> getLatencyReport();
+
+        // Returns the name of a stage as used in the latency report.
+        static const char* getLatencyStageName(LatencyStage stage);
+
+    private:
+        struct PendingDataStream
+        {
+            std::string dataStream;
+            int moduleId;
+            bool isTraced;
+            CubeSatFrameTrace trace;
+            uint32_t ingestTime;
+        };
+
+        struct ModuleLatency
+        {
+            CubeSatClockSync clockSync;
+            CubeSatLatencyStats stages[LATENCY_STAGE_COUNT];
+        };
+
+        std::vector<PendingDataStream> pendingDataStreams;
+        std::map<int, ModuleLatency> moduleLatencies;
 };
 
-#endif
\ No newline at end of file
+#endif
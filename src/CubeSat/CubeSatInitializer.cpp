@@ -24,6 +24,11 @@
             Builds an individual device based on configurations.
         generateDeviceVector:
             Generates a vector of devices created by buildDevice.
+        buildFilter:
+            Builds an individual field filter based on configurations.
+        configureFilters:
+            Attaches a filter stage to a device based on configurations,
+            checking that each filter emits once per refresh.
 ******************************************************************************/
 
 #include <SD.h>
@@ -35,6 +40,9 @@
 #include "CubeSatInitializer.h"
 #include "CubeSatHub.h"
 #include "./Devices/Temperature/CubeSatMS8607.h"
+#include "./Filters/CubeSatFilterStage.h"
+#include "./Filters/CubeSatCicFilter.h"
+#include "./Filters/CubeSatFirFilter.h"
 
 // Constants
 std::string CONFIG_FILE="/CubeSatConfig.json";
@@ -44,7 +52,11 @@ void errorBlink();
 JsonDocument loadConfig();
 bool initializeSdCard();
 CubeSatDevice* buildDevice(const char* deviceType, int deviceId);
-std::vector<CubeSatDevice*> generateDeviceVector(JsonArray deviceConfigurations);
+std::vector<CubeSatDevice*> generateDeviceVector(JsonArray deviceConfigurations,
+    unsigned long refreshInterval);
+CubeSatFilter* buildFilter(JsonObject filterConfiguration);
+void configureFilters(CubeSatDevice* device, JsonObject deviceConfiguration,
+    unsigned long refreshInterval);
 
 // Constructor
 CubeSatInitializer::CubeSatInitializer(){}
@@ -59,15 +71,17 @@ CubeSatModule* CubeSatInitializer::initializeCubeSat()
 
     const bool isHub = config["isHub"];
 
-    JsonArray deviceConfigurations = config["devices"];
+    unsigned long refreshInterval = CubeSatModule::DEFAULT_REFRESH_INTERVAL_MS;
+    refreshInterval = config["refreshIntervalMs"] | refreshInterval;
 
-    std::vector<CubeSatDevice*> devices = generateDeviceVector(deviceConfigurations);
-    if (!isHub)
-    {
-        return new CubeSatModule(false, cubeSatModuleId, devices);
-    }
+    JsonArray deviceConfigurations = config["devices"];
 
-    return new CubeSatHub(cubeSatModuleId, devices);
+    std::vector<CubeSatDevice*> devices = generateDeviceVector(deviceConfigurations, refreshInterval);
+    CubeSatModule* module = isHub
+        ? new CubeSatHub(cubeSatModuleId, devices)
+        : new CubeSatModule(false, cubeSatModuleId, devices);
+    module->setRefreshInterval(refreshInterval);
+    return module;
 };
 
 // Ensures SD card is connected and ready for read/write
@@ -140,13 +154,86 @@ CubeSatDevice* buildDevice(const char* deviceType, int deviceId)
     return nullptr;
 }
 
-std::vector<CubeSatDevice*> generateDeviceVector(JsonArray deviceConfigurations)
+std::vector<CubeSatDevice*> generateDeviceVector(JsonArray deviceConfigurations,
+    unsigned long refreshInterval)
 {   
     std::vector<CubeSatDevice*> devices;  // Vector should hold pointers to CubeSatDevice
     for (JsonObject deviceConfiguration : deviceConfigurations) 
     {
-        devices.push_back(buildDevice(deviceConfiguration["deviceType"], deviceConfiguration["id"]));
+        CubeSatDevice* device = buildDevice(deviceConfiguration["deviceType"], deviceConfiguration["id"]);
+        configureFilters(device, deviceConfiguration, refreshInterval);
+        devices.push_back(device);
     }
 
     return devices;
+}
+
+// Builds a field filter from its configuration, e.g.
+//     { "field": 1, "type": "cic", "decimation": 8, "order": 2 }
+//     { "field": 1, "type": "boxcar", "decimation": 8 }
+//     { "field": 1, "type": "fir", "decimation": 4, "taps": 15, "cutoff": 0.1 }
+CubeSatFilter* buildFilter(JsonObject filterConfiguration)
+{
+    const char* filterType = filterConfiguration["type"] | "";
+    int decimation = filterConfiguration["decimation"] | 1;
+
+    if (std::strcmp(filterType, "boxcar") == 0)
+    {
+        return new CubeSatCicFilter(decimation, 1);
+    }
+    if (std::strcmp(filterType, "cic") == 0)
+    {
+        return new CubeSatCicFilter(decimation, filterConfiguration["order"] | 1);
+    }
+    if (std::strcmp(filterType, "fir") == 0)
+    {
+        return new CubeSatFirFilter(decimation, filterConfiguration["taps"] | 15,
+            filterConfiguration["cutoff"] | 0.0);
+    }
+    return nullptr;
+}
+
+// Attaches a filter stage to a device if its configuration has filters.
+// Data streams are emitted once per refresh, so each filter must produce
+// exactly one output per refresh: sampleIntervalMs * decimation must equal
+// the module's refreshIntervalMs.
+void configureFilters(CubeSatDevice* device, JsonObject deviceConfiguration,
+    unsigned long refreshInterval)
+{
+    JsonArray filterConfigurations = deviceConfiguration["filters"];
+    if (!device || filterConfigurations.isNull())
+    {
+        return;
+    }
+
+    unsigned long sampleInterval = CubeSatDevice::DEFAULT_SAMPLE_INTERVAL_MS;
+    sampleInterval = deviceConfiguration["sampleIntervalMs"] | sampleInterval;
+
+    CubeSatFilterStage* filterStage = new CubeSatFilterStage();
+    for (JsonObject filterConfiguration : filterConfigurations)
+    {
+        CubeSatFilter* filter = buildFilter(filterConfiguration);
+        if (!filter)
+        {
+            continue;
+        }
+
+        // Blink continuously.
+        // A mismatched filter would emit stale or skipped outputs, and
+        // there's no ground contact before flight to report it to.
+        if (sampleInterval * filter->getDecimation() != refreshInterval)
+        {
+            errorBlink();
+        }
+        filterStage->setFilter(filterConfiguration["field"] | 0, filter);
+    }
+
+    if (!filterStage->hasFilters())
+    {
+        delete filterStage;
+        return;
+    }
+
+    device->setSampleInterval(sampleInterval);
+    device->setFilterStage(filterStage);
 }
\ No newline at end of file
@@ -20,6 +20,15 @@
                                      of the CubeSat's connected devices.
 
         devices:    vector<device> - Vector of CubeSatDevice objects.
+
+        clock:      CubeSatClock*  - Optional clock used to stamp captures and
+                                     encodes with latency trace timestamps.
+
+        refreshInterval: unsigned long - Milliseconds between data stream
+                                         refreshes.
+
+        lastRefresh: unsigned long     - Scheduled time of the most recent
+                                         refresh.
     Methods:
         getModuleId:
             Returns the id of the module.
@@ -38,17 +47,84 @@
         refreshDataStream:
             Iterates through devices vector and updates the module's
             dataStream with the collated device dataStreams. 
+
+        sampleDevices:
+            Feeds a sample into the filter stage of each online device
+            whose sample interval has elapsed.
+
+        setClock:
+            Sets the clock used for latency tracing. Data streams carry a
+            CubeSatFrameTrace once a clock is set.
+
+        getNextSampleTime:
+            Gets the earliest time an online device is due a sample.
+
+        setRefreshInterval:
+            Sets the number of milliseconds between data stream refreshes.
+
+        refreshIfDue:
+            Refreshes the data stream if the refresh interval has elapsed.
+
+        getNextRefreshTime:
+            Gets the time the data stream is next due a refresh.
 ******************************************************************************/
 
-#include <SD.h>
 #include "CubeSatModule.h"
 #include "CubeSatDataDiscriminators.h"
+#include "Timing/CubeSatFrameTrace.h"
 
 CubeSatModule::CubeSatModule
     (bool isHub, int moduleId, std::vector<CubeSatDevice*> devices): 
     isHub(isHub), moduleId(moduleId), devices(devices) {}
 
 
+// Sets the clock used for latency tracing.
+void CubeSatModule::setClock(CubeSatClock* clock)
+{
+    this->clock = clock;
+}
+
+// Returns the clock used for latency tracing.
+CubeSatClock* CubeSatModule::getClock()
+{
+    return this->clock;
+}
+
+// Sets the number of milliseconds between data stream refreshes.
+void CubeSatModule::setRefreshInterval(unsigned long refreshInterval)
+{
+    this->refreshInterval = refreshInterval;
+}
+
+// Returns the number of milliseconds between data stream refreshes.
+unsigned long CubeSatModule::getRefreshInterval()
+{
+    return this->refreshInterval;
+}
+
+// Refreshes the data stream if the refresh interval has elapsed since
+// the last refresh.
+bool CubeSatModule::refreshIfDue(unsigned long now)
+{
+    unsigned long lag = now - this->lastRefresh;
+    if (lag < this->refreshInterval)
+    {
+        return false;
+    }
+
+    // Keep to the schedule rather than the wake time, so refreshes stay
+    // in step with device samples. Refreshes missed entirely are skipped.
+    this->lastRefresh = now - lag % this->refreshInterval;
+    refreshDataStream();
+    return true;
+}
+
+// Gets the time the data stream is next due a refresh.
+unsigned long CubeSatModule::getNextRefreshTime()
+{
+    return this->lastRefresh + this->refreshInterval;
+}
+
 // Returns the id of the module.
 int CubeSatModule::getModuleId() 
 { 
@@ -84,6 +160,8 @@ void CubeSatModule::refreshDataStream()
     dataStream = std::to_string(moduleId) 
         + CubeSatDataDiscriminators::DEVICE_DISCRIMINATOR;
 
+    CubeSatFrameTrace trace;
+
     // Iterate through devices
     for (CubeSatDevice* device : devices)
     {
@@ -92,14 +170,76 @@ void CubeSatModule::refreshDataStream()
         {
             try
             {
+                // Filtered devices were stamped when last sampled, unless
+                // they have no samples yet and fall back to a fresh read.
+                CubeSatFilterStage* filterStage = device->getFilterStage();
+                if (clock && (!filterStage || !filterStage->hasSamples()))
+                {
+                    device->setCaptureTime(clock->micros());
+                }
+
                 // Append device's datastream
                 device->refreshDataStream();
                 dataStream += device->getDataStream();
+                trace.captureAges.push_back(device->getCaptureTime());
             }
             catch(...){}
         }
     }
 
+    // Append latency trace, converting capture times to ages
+    if (clock)
+    {
+        trace.encodeTime = clock->micros();
+        for (uint32_t& captureAge : trace.captureAges)
+        {
+            captureAge = trace.encodeTime - captureAge;
+        }
+        dataStream += trace.encode();
+    }
+
     // Append discriminator to signal end of module data
     dataStream += CubeSatDataDiscriminators::MODULE_DISCRIMINATOR;
+}
+
+// Feeds a sample into the filter stage of each online device
+// whose sample interval has elapsed.
+void CubeSatModule::sampleDevices(unsigned long now)
+{
+    for (CubeSatDevice* device : devices)
+    {
+        if (device->getStatus())
+        {
+            try
+            {
+                if (device->sampleIfDue(now) && clock)
+                {
+                    device->setCaptureTime(clock->micros());
+                }
+            }
+            catch(...){}
+        }
+    }
+}
+
+// Gets the earliest time an online device is due a sample.
+bool CubeSatModule::getNextSampleTime(unsigned long now, unsigned long& nextSampleTime)
+{
+    bool found = false;
+    for (CubeSatDevice* device : devices)
+    {
+        unsigned long deviceSampleTime;
+        if (!device->getStatus() || !device->getNextSampleTime(deviceSampleTime))
+        {
+            continue;
+        }
+
+        // Times wrap, so compare how far each is from now.
+        if (!found || static_cast<long>(deviceSampleTime - now) < static_cast<long>(nextSampleTime - now))
+        {
+            nextSampleTime = deviceSampleTime;
+            found = true;
+        }
+    }
+    return found;
 }
\ No newline at end of file
@@ -20,6 +20,15 @@
                                      of the CubeSat's connected devices.
 
         devices:    vector<device> - Vector of CubeSatDevice objects.
+
+        clock:      CubeSatClock*  - Optional clock used to stamp captures and
+                                     encodes with latency trace timestamps.
+
+        refreshInterval: unsigned long - Milliseconds between data stream
+                                         refreshes.
+
+        lastRefresh: unsigned long     - Scheduled time of the most recent
+                                         refresh.
     Methods:
         getModuleId:
             Returns the id of the module.
@@ -38,6 +47,26 @@
         refreshDataStream:
             Iterates through devices vector and updates the module's
             dataStream with the collated device dataStreams. 
+
+        sampleDevices:
+            Feeds a sample into the filter stage of each online device
+            whose sample interval has elapsed.
+
+        setClock:
+            Sets the clock used for latency tracing. Data streams carry a
+            CubeSatFrameTrace once a clock is set.
+
+        getNextSampleTime:
+            Gets the earliest time an online device is due a sample.
+
+        setRefreshInterval:
+            Sets the number of milliseconds between data stream refreshes.
+
+        refreshIfDue:
+            Refreshes the data stream if the refresh interval has elapsed.
+
+        getNextRefreshTime:
+            Gets the time the data stream is next due a refresh.
 ******************************************************************************/
 
 #ifndef CUBESAT_MODULE_H
@@ -47,10 +76,13 @@
 #include <vector>
 #include <memory>
 #include "CubeSatDevice.h"
+#include "Timing/CubeSatClock.h"
 
 class CubeSatModule
 {
     public:
+        static constexpr unsigned long DEFAULT_REFRESH_INTERVAL_MS = 1000;
+
         CubeSatModule(bool isHub, int moduleId, std::vector<CubeSatDevice*> devices);
 
         // Returns the id of the module.
@@ -71,6 +103,34 @@ class CubeSatModule
         // dataStream with the collated device dataStreams.
         void refreshDataStream();
 
+        // Feeds a sample into the filter stage of each online device
+        // whose sample interval has elapsed.
+        void sampleDevices(unsigned long now);
+
+        // Gets the earliest time an online device is due a sample. Returns
+        // false if no online device is sampled between refreshes.
+        bool getNextSampleTime(unsigned long now, unsigned long& nextSampleTime);
+
+        // Sets the clock used for latency tracing. Data streams carry a
+        // CubeSatFrameTrace once a clock is set.
+        void setClock(CubeSatClock* clock);
+
+        // Returns the clock used for latency tracing.
+        CubeSatClock* getClock();
+
+        // Sets the number of milliseconds between data stream refreshes.
+        void setRefreshInterval(unsigned long refreshInterval);
+
+        // Returns the number of milliseconds between data stream refreshes.
+        unsigned long getRefreshInterval();
+
+        // Refreshes the data stream if the refresh interval has elapsed
+        // since the last refresh. Returns true if refreshed.
+        bool refreshIfDue(unsigned long now);
+
+        // Gets the time the data stream is next due a refresh.
+        unsigned long getNextRefreshTime();
+
     private:
 
         // The unique ID of the CubeSat. Retrieved from 
@@ -87,6 +147,16 @@ class CubeSatModule
 
         // Vector of CubeSatDevice objects.
         std::vector<CubeSatDevice*> devices;
+
+        // Optional clock used to stamp captures and encodes with
+        // latency trace timestamps.
+        CubeSatClock* clock = nullptr;
+
+        // Milliseconds between data stream refreshes.
+        unsigned long refreshInterval = DEFAULT_REFRESH_INTERVAL_MS;
+
+        // Scheduled time of the most recent refresh.
+        unsigned long lastRefresh = 0;
 };
 
 #endif
\ No newline at end of file
@@ -21,6 +21,9 @@
         readSensor:
             Virtual method to read data from the device and append it to
             the device's datastream.
+        sampleFields:
+            Virtual method to read the temperature, pressure and humidity
+            fields from the device.
 ******************************************************************************/
 
 #include "CubeSatMS8607.h"
@@ -37,6 +40,16 @@ void CubeSatMS8607::initializeDevice(void* config)
 }
 
 std::string CubeSatMS8607::readSensor()
+{
+    double fields[FIELD_COUNT];
+    if (sampleFields(fields) == 0)
+    {
+        return "";
+    }
+    return formatFields(fields, FIELD_COUNT);
+}
+
+size_t CubeSatMS8607::sampleFields(double* fields)
 {
     try
     {
@@ -51,21 +64,14 @@ std::string CubeSatMS8607::readSensor()
 
         }
 
-        double temperatureVal = temp.temperature;
-        double pressureVal = pressure.pressure;
-        double humidityVal = humidity.relative_humidity;
-
-        return(
-                std::to_string(temperatureVal) + 
-                CubeSatDataDiscriminators::DATUM_DISCRIMINATOR +
-                std::to_string(pressureVal) +
-                CubeSatDataDiscriminators::DATUM_DISCRIMINATOR +
-                std::to_string(humidityVal)
-              );
+        fields[TEMPERATURE_FIELD] = temp.temperature;
+        fields[PRESSURE_FIELD] = pressure.pressure;
+        fields[HUMIDITY_FIELD] = humidity.relative_humidity;
+        return FIELD_COUNT;
     }
     catch(...)
     {
         setStatus(0);
     }
-    return "";
+    return 0;
 }
\ No newline at end of file
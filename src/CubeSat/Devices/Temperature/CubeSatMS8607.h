@@ -21,6 +21,9 @@
         readSensor:
             Virtual method to read data from the device and append it to
             the device's datastream.
+        sampleFields:
+            Virtual method to read the temperature, pressure and humidity
+            fields from the device.
 ******************************************************************************/
 
 #ifndef CUBESAT_MS8607_H
@@ -40,6 +43,12 @@ struct CubeSatMS8607Config
 class CubeSatMS8607 : public CubeSatDevice
 {
     public:
+        // Field order of the device's data stream.
+        static constexpr size_t TEMPERATURE_FIELD = 0;
+        static constexpr size_t PRESSURE_FIELD = 1;
+        static constexpr size_t HUMIDITY_FIELD = 2;
+        static constexpr size_t FIELD_COUNT = 3;
+
         CubeSatMS8607(int deviceId) 
             : CubeSatDevice(deviceId, CubeSatDeviceTypes::MS8607), 
             humidityResolution(MS8607_HUMIDITY_RESOLUTION_OSR_8b), 
@@ -60,6 +69,7 @@ class CubeSatMS8607 : public CubeSatDevice
 
         virtual void initializeDevice(void* config);
         virtual std::string readSensor();
+        virtual size_t sampleFields(double* fields);
 
     private:
         int humidityResolution;
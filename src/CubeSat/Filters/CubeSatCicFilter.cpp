@@ -0,0 +1,81 @@
+// CubeSatCicFilter.cpp
+
+/******************************************************************************
+    CubeSatCicFilter Class Implementation
+
+    Purpose:
+        CubeSatFilter subclass. Cascaded integrator-comb decimator. An order
+        of 1 is a boxcar (moving average) decimator.
+    Methods:
+        process:
+            Filters a block of samples.
+        reset:
+            Clears the filter state.
+******************************************************************************/
+
+#include "CubeSatCicFilter.h"
+
+CubeSatCicFilter::CubeSatCicFilter(int decimation, int order) : CubeSatFilter(decimation)
+{
+    this->order = order < 1 ? 1 : (order > MAX_ORDER ? MAX_ORDER : order);
+
+    // The DC gain of the cascade is decimation ^ order.
+    gain = 1;
+    for (int stage = 0; stage < this->order; stage++)
+    {
+        gain *= this->decimation;
+    }
+
+    reset();
+}
+
+// Filters a block of samples.
+size_t CubeSatCicFilter::process(const int32_t* input, size_t count, int32_t* output)
+{
+    size_t outputCount = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        // Integrate at the input rate. Unsigned arithmetic gives
+        // well-defined wraparound.
+        uint64_t value = static_cast<uint64_t>(static_cast<int64_t>(input[i]));
+        for (int stage = 0; stage < order; stage++)
+        {
+            integrators[stage] += value;
+            value = integrators[stage];
+        }
+
+        if (++phase < decimation)
+        {
+            continue;
+        }
+        phase = 0;
+
+        // Differentiate at the output rate.
+        for (int stage = 0; stage < order; stage++)
+        {
+            uint64_t previous = combs[stage];
+            combs[stage] = value;
+            value -= previous;
+        }
+
+        if (warmup > 0)
+        {
+            warmup--;
+            continue;
+        }
+        output[outputCount++] = static_cast<int32_t>(static_cast<int64_t>(value) / gain);
+    }
+    return outputCount;
+}
+
+// Clears the filter state.
+void CubeSatCicFilter::reset()
+{
+    phase = 0;
+    warmup = order - 1;
+    for (int stage = 0; stage < MAX_ORDER; stage++)
+    {
+        integrators[stage] = 0;
+        combs[stage] = 0;
+    }
+}
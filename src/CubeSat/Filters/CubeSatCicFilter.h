@@ -0,0 +1,54 @@
+// CubeSatCicFilter.h
+
+/******************************************************************************
+    CubeSatCicFilter Class Header
+
+    Purpose:
+        CubeSatFilter subclass. Cascaded integrator-comb decimator. The
+        integrators run at the input rate and the combs at the output rate,
+        so each input sample costs only order additions. An order of 1 is
+        a boxcar (moving average) decimator.
+
+        Integrators are allowed to wrap; the combs undo the wrap as long as
+        the true output fits in 64 bits. Output is normalized to unity DC
+        gain. The first order - 1 outputs are discarded while the filter
+        fills.
+    Attributes:
+        order:          integer      - Number of integrator/comb stages.
+        gain:           int64_t      - DC gain of the cascade.
+        phase:          integer      - Input samples since the last output.
+        warmup:         integer      - Outputs remaining to be discarded.
+        integrators:    uint64_t[]   - Integrator stage state.
+        combs:          uint64_t[]   - Previous comb stage inputs.
+    Methods:
+        process:
+            Filters a block of samples.
+        reset:
+            Clears the filter state.
+******************************************************************************/
+
+#ifndef CUBESAT_CIC_FILTER_H
+#define CUBESAT_CIC_FILTER_H
+
+#include "CubeSatFilter.h"
+
+class CubeSatCicFilter : public CubeSatFilter
+{
+    public:
+        static constexpr int MAX_ORDER = 4;
+
+        CubeSatCicFilter(int decimation, int order = 1);
+
+        virtual size_t process(const int32_t* input, size_t count, int32_t* output);
+        virtual void reset();
+
+    private:
+        int order;
+        int64_t gain;
+        int phase;
+        int warmup;
+        uint64_t integrators[MAX_ORDER];
+        uint64_t combs[MAX_ORDER];
+};
+
+#endif
@@ -0,0 +1,50 @@
+// CubeSatFilter.h
+
+/******************************************************************************
+    CubeSatFilter Class Header
+
+    Purpose:
+        Base class for fixed-point decimating filters applied to a single
+        device field. Samples are processed in blocks so a device can be
+        sampled at a high internal rate and emitted at a lower output rate.
+    Attributes:
+        decimation: integer - Number of input samples per output sample.
+    Methods:
+        process:
+            Virtual method to filter a block of samples.
+        reset:
+            Virtual method to clear the filter state.
+        getDecimation:
+            Returns the decimation factor.
+******************************************************************************/
+
+#ifndef CUBESAT_FILTER_H
+#define CUBESAT_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+class CubeSatFilter
+{
+    public:
+        virtual ~CubeSatFilter() {}
+
+        // Filters a block of count samples, writing one sample to output
+        // for every decimation period completed. output must have room
+        // for count / decimation + 1 samples. Returns the number of
+        // samples written.
+        virtual size_t process(const int32_t* input, size_t count, int32_t* output) = 0;
+
+        // Clears the filter state.
+        virtual void reset() = 0;
+
+        // Returns the decimation factor.
+        int getDecimation() { return this->decimation; }
+
+    protected:
+        CubeSatFilter(int decimation) : decimation(decimation < 1 ? 1 : decimation) {}
+
+        int decimation;
+};
+
+#endif
@@ -0,0 +1,157 @@
+// CubeSatFilterStage.cpp
+
+/******************************************************************************
+    CubeSatFilterStage Class Implementation
+
+    Purpose:
+        Sits between a device read and its data stream encoding, filtering
+        each field's samples in fixed-point blocks.
+    Methods:
+        setFilter:
+            Assigns a filter to a field. The stage owns the filter.
+        hasFilters:
+            Returns whether any field is filtered.
+        hasSamples:
+            Returns whether any sample has been added, i.e. whether
+            readOutputs has fields to return.
+        addSample:
+            Buffers a sample of every field, processing the block once it
+            is full.
+        readOutputs:
+            Processes any buffered samples and returns the latest value of
+            each field.
+******************************************************************************/
+
+#include <cmath>
+#include <cstdint>
+#include "CubeSatFilterStage.h"
+
+CubeSatFilterStage::CubeSatFilterStage()
+{
+    for (size_t field = 0; field < MAX_FIELDS; field++)
+    {
+        filters[field] = nullptr;
+        outputs[field] = 0.0;
+        settled[field] = false;
+    }
+}
+
+CubeSatFilterStage::~CubeSatFilterStage()
+{
+    for (size_t field = 0; field < MAX_FIELDS; field++)
+    {
+        delete filters[field];
+    }
+}
+
+// Assigns a filter to a field. The stage owns the filter.
+bool CubeSatFilterStage::setFilter(size_t field, CubeSatFilter* filter)
+{
+    if (field >= MAX_FIELDS)
+    {
+        delete filter;
+        return false;
+    }
+
+    delete filters[field];
+    filters[field] = filter;
+    settled[field] = false;
+    return true;
+}
+
+// Returns whether any field is filtered.
+bool CubeSatFilterStage::hasFilters()
+{
+    for (size_t field = 0; field < MAX_FIELDS; field++)
+    {
+        if (filters[field])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Returns whether any sample has been added.
+bool CubeSatFilterStage::hasSamples()
+{
+    return fieldCount > 0;
+}
+
+// Buffers a sample of every field, processing the block once it is full.
+void CubeSatFilterStage::addSample(const double* fields, size_t count)
+{
+    fieldCount = count < MAX_FIELDS ? count : MAX_FIELDS;
+    for (size_t field = 0; field < fieldCount; field++)
+    {
+        // Unfiltered fields skip the fixed-point round trip, and
+        // filtered fields pass through until their filter has settled.
+        if (!settled[field])
+        {
+            outputs[field] = fields[field];
+        }
+        if (!filters[field])
+        {
+            continue;
+        }
+
+        // Readings too large for the fixed-point range saturate rather
+        // than overflow.
+        double scaled = fields[field] * FIXED_POINT_SCALE;
+        if (scaled >= INT32_MAX)
+        {
+            blocks[field][blockCount] = INT32_MAX;
+        }
+        else if (scaled <= INT32_MIN)
+        {
+            blocks[field][blockCount] = INT32_MIN;
+        }
+        else
+        {
+            blocks[field][blockCount] = static_cast<int32_t>(std::lround(scaled));
+        }
+    }
+
+    if (++blockCount == BLOCK_SIZE)
+    {
+        processBlock();
+    }
+}
+
+// Processes any buffered samples and writes the latest value of each
+// field to fields.
+size_t CubeSatFilterStage::readOutputs(double* fields)
+{
+    processBlock();
+    for (size_t field = 0; field < fieldCount; field++)
+    {
+        fields[field] = outputs[field];
+    }
+    return fieldCount;
+}
+
+// Runs each field's filter over the buffered samples.
+void CubeSatFilterStage::processBlock()
+{
+    if (blockCount == 0)
+    {
+        return;
+    }
+
+    int32_t filtered[BLOCK_SIZE + 1];
+    for (size_t field = 0; field < fieldCount; field++)
+    {
+        if (!filters[field])
+        {
+            continue;
+        }
+
+        size_t outputCount = filters[field]->process(blocks[field], blockCount, filtered);
+        if (outputCount > 0)
+        {
+            outputs[field] = filtered[outputCount - 1] / FIXED_POINT_SCALE;
+            settled[field] = true;
+        }
+    }
+    blockCount = 0;
+}
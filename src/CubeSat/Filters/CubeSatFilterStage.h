@@ -0,0 +1,86 @@
+// CubeSatFilterStage.h
+
+/******************************************************************************
+    CubeSatFilterStage Class Header
+
+    Purpose:
+        Sits between a device read and its data stream encoding. Buffers
+        each field's samples in fixed-point blocks and runs the field's
+        filter over a whole block at once, keeping the latest filtered
+        value of each field ready to be emitted. Fields without a filter
+        pass through their latest sample.
+    Attributes:
+        filters:        CubeSatFilter*[] - Filter for each field, or nullptr.
+        fieldCount:     integer          - Number of fields being sampled.
+        blocks:         int32_t[][]      - Buffered samples for each field.
+        blockCount:     integer          - Number of buffered samples.
+        outputs:        double[]         - Latest value of each field.
+        settled:        bool[]           - Whether each field's filter has
+                                           produced an output yet.
+    Methods:
+        setFilter:
+            Assigns a filter to a field. The stage owns the filter.
+        hasFilters:
+            Returns whether any field is filtered.
+        hasSamples:
+            Returns whether any sample has been added, i.e. whether
+            readOutputs has fields to return.
+        addSample:
+            Buffers a sample of every field, processing the block once it
+            is full.
+        readOutputs:
+            Processes any buffered samples and returns the latest value of
+            each field.
+******************************************************************************/
+
+#ifndef CUBESAT_FILTER_STAGE_H
+#define CUBESAT_FILTER_STAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "CubeSatFilter.h"
+
+class CubeSatFilterStage
+{
+    public:
+        static constexpr size_t MAX_FIELDS = 8;
+        static constexpr size_t BLOCK_SIZE = 16;
+
+        // Fields are filtered in fixed point with this many counts per unit.
+        // Readings beyond about +/-2.1e6 units saturate.
+        static constexpr double FIXED_POINT_SCALE = 1000.0;
+
+        CubeSatFilterStage();
+        ~CubeSatFilterStage();
+
+        // Assigns a filter to a field. The stage owns the filter.
+        bool setFilter(size_t field, CubeSatFilter* filter);
+
+        // Returns whether any field is filtered.
+        bool hasFilters();
+
+        // Returns whether any sample has been added, i.e. whether
+        // readOutputs has fields to return.
+        bool hasSamples();
+
+        // Buffers a sample of every field, processing the block once it
+        // is full.
+        void addSample(const double* fields, size_t count);
+
+        // Processes any buffered samples and writes the latest value of
+        // each field to fields. Returns the number of fields written.
+        size_t readOutputs(double* fields);
+
+    private:
+        // Runs each field's filter over the buffered samples.
+        void processBlock();
+
+        CubeSatFilter* filters[MAX_FIELDS];
+        size_t fieldCount = 0;
+        int32_t blocks[MAX_FIELDS][BLOCK_SIZE];
+        size_t blockCount = 0;
+        double outputs[MAX_FIELDS];
+        bool settled[MAX_FIELDS];
+};
+
+#endif
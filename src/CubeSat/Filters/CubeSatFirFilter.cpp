@@ -0,0 +1,119 @@
+// CubeSatFirFilter.cpp
+
+/******************************************************************************
+    CubeSatFirFilter Class Implementation
+
+    Purpose:
+        CubeSatFilter subclass. Short fixed-point FIR low-pass decimator.
+    Methods:
+        process:
+            Filters a block of samples.
+        reset:
+            Clears the filter state.
+        getTap:
+            Returns a Q15 filter coefficient.
+******************************************************************************/
+
+#include <cmath>
+#include "CubeSatFirFilter.h"
+
+// Fixed-point format of the filter taps.
+static constexpr int TAP_FRACTION_BITS = 15;
+static constexpr int32_t TAP_ONE = 1 << TAP_FRACTION_BITS;
+
+CubeSatFirFilter::CubeSatFirFilter(int decimation, int tapCount, double cutoff)
+    : CubeSatFilter(decimation)
+{
+    this->tapCount = tapCount < 3 ? 3 : (tapCount > MAX_TAPS ? MAX_TAPS : tapCount);
+    if (!(cutoff > 0.0 && cutoff < 0.5))
+    {
+        // Default to the Nyquist frequency of the output rate.
+        cutoff = 0.5 / this->decimation;
+    }
+
+    // Design a Hamming-windowed sinc.
+    const double pi = 3.14159265358979323846;
+    double center = (this->tapCount - 1) / 2.0;
+    double design[MAX_TAPS];
+    double sum = 0.0;
+    for (int n = 0; n < this->tapCount; n++)
+    {
+        double offset = n - center;
+        double sinc = offset == 0.0
+            ? 2.0 * cutoff
+            : std::sin(2.0 * pi * cutoff * offset) / (pi * offset);
+        double window = 0.54 - 0.46 * std::cos(2.0 * pi * n / (this->tapCount - 1));
+        design[n] = sinc * window;
+        sum += design[n];
+    }
+
+    // Quantize with unity DC gain, folding the rounding error into the
+    // center tap so a constant input passes through unchanged.
+    int32_t quantizedSum = 0;
+    for (int n = 0; n < this->tapCount; n++)
+    {
+        taps[n] = static_cast<int32_t>(std::lround(design[n] / sum * TAP_ONE));
+        quantizedSum += taps[n];
+    }
+    taps[this->tapCount / 2] += TAP_ONE - quantizedSum;
+
+    reset();
+}
+
+// Filters a block of samples.
+size_t CubeSatFirFilter::process(const int32_t* input, size_t count, int32_t* output)
+{
+    size_t outputCount = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!primed)
+        {
+            for (int n = 0; n < 2 * tapCount; n++)
+            {
+                history[n] = input[i];
+            }
+            primed = true;
+        }
+
+        // Store the sample twice so the window starting at position is
+        // always contiguous.
+        history[position] = input[i];
+        history[position + tapCount] = input[i];
+        if (++position == tapCount)
+        {
+            position = 0;
+        }
+
+        if (++phase < decimation)
+        {
+            continue;
+        }
+        phase = 0;
+
+        const int32_t* window = &history[position];
+        int64_t accumulator = 0;
+        for (int n = 0; n < tapCount; n++)
+        {
+            accumulator += static_cast<int64_t>(taps[n]) * window[n];
+        }
+        output[outputCount++] = static_cast<int32_t>(
+            (accumulator + (TAP_ONE / 2)) >> TAP_FRACTION_BITS);
+    }
+    return outputCount;
+}
+
+// Clears the filter state.
+void CubeSatFirFilter::reset()
+{
+    position = 0;
+    phase = 0;
+    primed = false;
+}
+
+// Returns a Q15 filter coefficient.
+int32_t CubeSatFirFilter::getTap(int index)
+{
+    return index >= 0 && index < tapCount ? taps[index] : 0;
+}
+
+int CubeSatFirFilter::getTapCount() { return this->tapCount; }
@@ -0,0 +1,59 @@
+// CubeSatFirFilter.h
+
+/******************************************************************************
+    CubeSatFirFilter Class Header
+
+    Purpose:
+        CubeSatFilter subclass. Short fixed-point FIR low-pass decimator.
+        Taps are designed as a Hamming-windowed sinc and quantized to Q15
+        with unity DC gain. Outputs are only computed at the decimated
+        rate. The history is seeded with the first sample so the filter
+        produces settled outputs immediately.
+    Attributes:
+        tapCount:   integer   - Number of filter taps.
+        taps:       int32_t[] - Q15 filter coefficients.
+        history:    int32_t[] - Most recent input samples, stored twice so
+                                each output is one contiguous dot product.
+        position:   integer   - Index of the oldest sample in history.
+        phase:      integer   - Input samples since the last output.
+        primed:     bool      - Whether history has been seeded.
+    Methods:
+        process:
+            Filters a block of samples.
+        reset:
+            Clears the filter state.
+        getTap:
+            Returns a Q15 filter coefficient.
+******************************************************************************/
+
+#ifndef CUBESAT_FIR_FILTER_H
+#define CUBESAT_FIR_FILTER_H
+
+#include "CubeSatFilter.h"
+
+class CubeSatFirFilter : public CubeSatFilter
+{
+    public:
+        static constexpr int MAX_TAPS = 32;
+
+        // cutoff is the -6 dB frequency as a fraction of the input sample
+        // rate, between 0 and 0.5.
+        CubeSatFirFilter(int decimation, int tapCount, double cutoff);
+
+        virtual size_t process(const int32_t* input, size_t count, int32_t* output);
+        virtual void reset();
+
+        // Returns a Q15 filter coefficient.
+        int32_t getTap(int index);
+        int getTapCount();
+
+    private:
+        int tapCount;
+        int32_t taps[MAX_TAPS];
+        int32_t history[2 * MAX_TAPS];
+        int position;
+        int phase;
+        bool primed;
+};
+
+#endif
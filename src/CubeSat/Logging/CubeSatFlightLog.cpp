@@ -0,0 +1,444 @@
+// CubeSatFlightLog.cpp
+
+/******************************************************************************
+    CubeSatFlightLog Class Implementation
+
+    Purpose:
+        Appends module data streams to the on-board flight log and maintains
+        a sparse sidecar index mapping sequence number and timestamp to a
+        byte offset in the log.
+    Methods:
+        begin:
+            Opens the log and index, recovering the sequence number and
+            rebuilding the index if it is missing or inconsistent.
+        append:
+            Appends a record to the log, indexing it if required.
+        flush:
+            Commits buffered log and index writes to storage.
+        rebuildIndex:
+            Discards the index and regenerates it by scanning the log.
+        findIndexEntry:
+            Finds the last index entry at or before a sequence number or
+            (boot, timestamp).
+        parseRecord:
+            Splits a log record line into its fields.
+    Helper Functions:
+        parseField:
+            Parses an unsigned decimal field terminated by a separator.
+******************************************************************************/
+
+#include <cstring>
+#include "CubeSatFlightLog.h"
+
+// Size of the buffer used when scanning the log.
+static constexpr size_t SCAN_BUFFER_SIZE = 512;
+
+// Prototypes
+bool parseField(const char*& cursor, const char* end, uint32_t& value);
+
+void CubeSatLogIndexEntry::encode(uint8_t* buffer) const
+{
+    const uint32_t fields[] = { boot, sequence, timestamp, offset };
+    for (uint32_t field : fields)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            *buffer++ = static_cast<uint8_t>(field >> (8 * i));
+        }
+    }
+}
+
+CubeSatLogIndexEntry CubeSatLogIndexEntry::decode(const uint8_t* buffer)
+{
+    uint32_t fields[4] = { 0, 0, 0, 0 };
+    for (uint32_t& field : fields)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            field |= static_cast<uint32_t>(*buffer++) << (8 * i);
+        }
+    }
+
+    CubeSatLogIndexEntry entry;
+    entry.boot = fields[0];
+    entry.sequence = fields[1];
+    entry.timestamp = fields[2];
+    entry.offset = fields[3];
+    return entry;
+}
+
+CubeSatFlightLog::CubeSatFlightLog(CubeSatLogStorage* storage, const char* logPath,
+    const char* indexPath, uint32_t indexInterval)
+    : storage(storage), logPath(logPath), indexPath(indexPath), indexInterval(indexInterval) {}
+
+CubeSatFlightLog::~CubeSatFlightLog()
+{
+    close();
+}
+
+// Opens the log and index, recovering the sequence number and
+// rebuilding the index if it is missing or inconsistent.
+bool CubeSatFlightLog::begin()
+{
+    close();
+    recordIsTorn = false;
+    indexIsBroken = false;
+
+    logFile = storage->open(logPath, true);
+    if (!logFile)
+    {
+        return false;
+    }
+    logSize = logFile->size();
+
+    // Read the last index entry. The index is only trusted if it is made
+    // up of whole entries and its last entry points inside the log.
+    CubeSatLogIndexEntry lastEntry;
+    bool indexIsValid = false;
+    CubeSatLogFile* indexReader = storage->open(indexPath, false);
+    if (indexReader)
+    {
+        uint32_t indexSize = indexReader->size();
+        uint8_t buffer[CubeSatLogIndexEntry::ENCODED_SIZE];
+        indexEntryCount = indexSize / CubeSatLogIndexEntry::ENCODED_SIZE;
+
+        if (indexSize % CubeSatLogIndexEntry::ENCODED_SIZE == 0 && indexEntryCount > 0
+            && indexReader->seek(indexSize - CubeSatLogIndexEntry::ENCODED_SIZE)
+            && indexReader->read(buffer, sizeof(buffer)) == sizeof(buffer))
+        {
+            lastEntry = CubeSatLogIndexEntry::decode(buffer);
+            indexIsValid = lastEntry.offset < logSize;
+        }
+        delete indexReader;
+    }
+
+    if (!indexIsValid)
+    {
+        if (!rebuildIndex())
+        {
+            return false;
+        }
+    }
+    else
+    {
+        indexFile = storage->open(indexPath, true);
+        if (!indexFile)
+        {
+            return false;
+        }
+
+        // Pick up from the last indexed record to recover the sequence
+        // number and index anything written after the index was last
+        // updated.
+        lastIndexedOffset = lastEntry.offset;
+        nextSequence = lastEntry.sequence;
+        lastBoot = lastEntry.boot;
+        if (!scanLog(lastEntry.offset))
+        {
+            return false;
+        }
+    }
+
+    // Timestamps restart with the module, so records appended from now on
+    // belong to a new boot.
+    boot = nextSequence > 0 ? lastBoot + 1 : 0;
+    return true;
+}
+
+// Appends a record to the log, indexing it if required.
+bool CubeSatFlightLog::append(uint32_t timestamp, const std::string& frame)
+{
+    if (!logFile || frame.find(RECORD_TERMINATOR) != std::string::npos)
+    {
+        return false;
+    }
+
+    // A record torn by an earlier short write must be ended first, or
+    // this record would be glued onto it.
+    if (recordIsTorn && !terminateRecord())
+    {
+        return false;
+    }
+
+    std::string record = std::to_string(boot) + FIELD_SEPARATOR
+        + std::to_string(nextSequence) + FIELD_SEPARATOR
+        + std::to_string(timestamp) + FIELD_SEPARATOR
+        + frame + RECORD_TERMINATOR;
+
+    uint32_t offset = logSize;
+    size_t written = logFile->write(reinterpret_cast<const uint8_t*>(record.data()), record.size());
+    logSize += written;
+    if (written != record.size())
+    {
+        // The fragment keeps its sequence number, as it would if scanLog
+        // recovered it at boot, and is ended where it stops.
+        if (written > 0)
+        {
+            nextSequence++;
+            recordIsTorn = true;
+            terminateRecord();
+        }
+        return false;
+    }
+
+    // A failed index write stops indexing until the next rebuild.
+    if (!indexIsBroken && (indexEntryCount == 0 || offset >= lastIndexedOffset + indexInterval))
+    {
+        writeIndexEntry(boot, nextSequence, timestamp, offset);
+    }
+    nextSequence++;
+    return true;
+}
+
+// Commits buffered log and index writes to storage.
+void CubeSatFlightLog::flush()
+{
+    if (logFile)
+    {
+        logFile->flush();
+    }
+    if (indexFile)
+    {
+        indexFile->flush();
+    }
+}
+
+// Discards the index and regenerates it by scanning the log.
+bool CubeSatFlightLog::rebuildIndex()
+{
+    if (!logFile)
+    {
+        return false;
+    }
+
+    delete indexFile;
+    indexFile = nullptr;
+    if (!storage->remove(indexPath))
+    {
+        return false;
+    }
+
+    indexFile = storage->open(indexPath, true);
+    if (!indexFile)
+    {
+        return false;
+    }
+
+    indexEntryCount = 0;
+    indexIsBroken = false;
+    nextSequence = 0;
+    lastIndexedOffset = 0;
+    lastBoot = 0;
+    return scanLog(0);
+}
+
+// Finds the last index entry whose sequence number (or boot and
+// timestamp) is at or before key.
+bool CubeSatFlightLog::findIndexEntry(uint64_t key, bool byTimestamp, CubeSatLogIndexEntry& entry)
+{
+    // Default to the start of the log.
+    entry = CubeSatLogIndexEntry();
+    if (indexIsBroken)
+    {
+        return true;
+    }
+
+    flush();
+    CubeSatLogFile* indexReader = storage->open(indexPath, false);
+    if (!indexReader)
+    {
+        return false;
+    }
+
+    // Binary search the index in place. Entries are written in log
+    // order, so both sequence numbers and (boot, timestamp) pairs are
+    // ascending.
+    uint32_t low = 0;
+    uint32_t high = indexReader->size() / CubeSatLogIndexEntry::ENCODED_SIZE;
+    bool success = true;
+    while (low < high)
+    {
+        uint32_t middle = low + (high - low) / 2;
+        uint8_t buffer[CubeSatLogIndexEntry::ENCODED_SIZE];
+        if (!indexReader->seek(middle * CubeSatLogIndexEntry::ENCODED_SIZE)
+            || indexReader->read(buffer, sizeof(buffer)) != sizeof(buffer))
+        {
+            success = false;
+            break;
+        }
+
+        CubeSatLogIndexEntry candidate = CubeSatLogIndexEntry::decode(buffer);
+        uint64_t candidateKey = byTimestamp
+            ? cubeSatLogTimeKey(candidate.boot, candidate.timestamp)
+            : candidate.sequence;
+        if (candidateKey <= key)
+        {
+            entry = candidate;
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    delete indexReader;
+    return success;
+}
+
+// Splits a log record line, excluding its terminator, into its fields.
+bool CubeSatFlightLog::parseRecord(const char* line, size_t length, CubeSatLogRecord& record)
+{
+    const char* cursor = line;
+    const char* end = line + length;
+    if (!parseField(cursor, end, record.boot) || !parseField(cursor, end, record.sequence)
+        || !parseField(cursor, end, record.timestamp))
+    {
+        return false;
+    }
+
+    record.frame = cursor;
+    record.frameLength = end - cursor;
+    return true;
+}
+
+// Getters
+CubeSatLogStorage* CubeSatFlightLog::getStorage() { return this->storage; }
+const char* CubeSatFlightLog::getLogPath() { return this->logPath; }
+uint32_t CubeSatFlightLog::getLogSize() { return this->logSize; }
+uint32_t CubeSatFlightLog::getNextSequence() { return this->nextSequence; }
+uint32_t CubeSatFlightLog::getIndexEntryCount() { return this->indexEntryCount; }
+uint32_t CubeSatFlightLog::getBoot() { return this->boot; }
+
+// Writes an index entry for a record starting at offset.
+bool CubeSatFlightLog::writeIndexEntry(uint32_t boot, uint32_t sequence, uint32_t timestamp, uint32_t offset)
+{
+    CubeSatLogIndexEntry entry;
+    entry.boot = boot;
+    entry.sequence = sequence;
+    entry.timestamp = timestamp;
+    entry.offset = offset;
+
+    uint8_t buffer[CubeSatLogIndexEntry::ENCODED_SIZE];
+    entry.encode(buffer);
+    if (indexFile->write(buffer, sizeof(buffer)) != sizeof(buffer))
+    {
+        // A partial entry misaligns every entry after it. The index is
+        // rebuilt when the log is next opened.
+        indexIsBroken = true;
+        return false;
+    }
+
+    indexEntryCount++;
+    lastIndexedOffset = offset;
+    return true;
+}
+
+// Walks the log from offset to the end, indexing records and advancing
+// the sequence number as if they had just been appended.
+bool CubeSatFlightLog::scanLog(uint32_t offset)
+{
+    logFile->flush();
+    CubeSatLogFile* logReader = storage->open(logPath, false);
+    if (!logReader)
+    {
+        return false;
+    }
+    if (!logReader->seek(offset))
+    {
+        delete logReader;
+        return false;
+    }
+
+    std::string line;
+    uint32_t lineOffset = offset;
+    uint32_t position = offset;
+    uint8_t buffer[SCAN_BUFFER_SIZE];
+    size_t bytesRead;
+    while ((bytesRead = logReader->read(buffer, sizeof(buffer))) > 0)
+    {
+        const char* cursor = reinterpret_cast<const char*>(buffer);
+        const char* end = cursor + bytesRead;
+        while (cursor < end)
+        {
+            const char* terminator = static_cast<const char*>(
+                std::memchr(cursor, RECORD_TERMINATOR, end - cursor));
+            if (!terminator)
+            {
+                line.append(cursor, end);
+                position += end - cursor;
+                break;
+            }
+
+            line.append(cursor, terminator);
+            position += (terminator - cursor) + 1;
+            cursor = terminator + 1;
+
+            CubeSatLogRecord record;
+            if (parseRecord(line.data(), line.size(), record))
+            {
+                if (!indexIsBroken && (indexEntryCount == 0 || lineOffset >= lastIndexedOffset + indexInterval))
+                {
+                    writeIndexEntry(record.boot, record.sequence, record.timestamp, lineOffset);
+                }
+                nextSequence = record.sequence + 1;
+                lastBoot = record.boot;
+            }
+            line.clear();
+            lineOffset = position;
+        }
+    }
+    delete logReader;
+
+    // Terminate a record left incomplete by an interrupted write so the
+    // next record starts on its own line.
+    if (!line.empty())
+    {
+        recordIsTorn = true;
+        terminateRecord();
+    }
+    return true;
+}
+
+// Ends a torn record so the next record starts on its own line.
+bool CubeSatFlightLog::terminateRecord()
+{
+    uint8_t terminator = RECORD_TERMINATOR;
+    if (logFile->write(&terminator, 1) != 1)
+    {
+        return false;
+    }
+    logSize++;
+    recordIsTorn = false;
+    return true;
+}
+
+// Closes the log and index files.
+void CubeSatFlightLog::close()
+{
+    flush();
+    delete logFile;
+    delete indexFile;
+    logFile = nullptr;
+    indexFile = nullptr;
+}
+
+// Parses an unsigned decimal field terminated by a separator, leaving
+// the cursor after the separator.
+bool parseField(const char*& cursor, const char* end, uint32_t& value)
+{
+    const char* start = cursor;
+    value = 0;
+    while (cursor < end && *cursor >= '0' && *cursor <= '9')
+    {
+        value = value * 10 + (*cursor - '0');
+        cursor++;
+    }
+
+    if (cursor == start || cursor == end || *cursor != CubeSatFlightLog::FIELD_SEPARATOR)
+    {
+        return false;
+    }
+    cursor++;
+    return true;
+}
@@ -0,0 +1,182 @@
+// CubeSatFlightLog.h
+
+/******************************************************************************
+    CubeSatFlightLog Class Header
+
+    Purpose:
+        Appends module data streams to the on-board flight log and maintains
+        a sparse sidecar index mapping sequence number and timestamp to a
+        byte offset in the log. The index lets a ground-side export seek
+        straight to a time range instead of reading the whole log.
+
+        Each log record is a single line:
+            <boot>,<sequence>,<timestamp>,<module data stream>\n
+        Timestamps restart on every boot while the log keeps growing, so
+        records are ordered in time by (boot, timestamp). The boot number
+        is one more than the last boot found in the log when it is opened.
+        An index entry is written for the first record and then for the
+        first record starting at least indexInterval bytes after the
+        previously indexed record. Entries are fixed-size binary records
+        so the index can be binary searched in place.
+    Attributes:
+        storage:            CubeSatLogStorage* - Storage medium holding the
+                                                 log and index files.
+        logPath:            const char*        - Path of the log file.
+        indexPath:          const char*        - Path of the index file.
+        indexInterval:      uint32_t           - Minimum number of log bytes
+                                                 between index entries.
+        logFile:            CubeSatLogFile*    - Log file open for appending.
+        indexFile:          CubeSatLogFile*    - Index file open for
+                                                 appending.
+        logSize:            uint32_t           - Current size of the log.
+        nextSequence:       uint32_t           - Sequence number of the
+                                                 next record.
+        lastIndexedOffset:  uint32_t           - Offset of the most recently
+                                                 indexed record.
+        indexEntryCount:    uint32_t           - Number of index entries.
+        boot:               uint32_t           - Boot number of records
+                                                 appended this session.
+        lastBoot:           uint32_t           - Boot number of the last
+                                                 record found when opening.
+        recordIsTorn:       bool               - Whether the log ends in a
+                                                 record left incomplete by a
+                                                 short write.
+        indexIsBroken:      bool               - Whether an index write
+                                                 failed, leaving the index
+                                                 unusable until rebuilt.
+    Methods:
+        begin:
+            Opens the log and index, recovering the sequence number and
+            rebuilding the index if it is missing or inconsistent.
+        append:
+            Appends a record to the log, indexing it if required.
+        flush:
+            Commits buffered log and index writes to storage.
+        rebuildIndex:
+            Discards the index and regenerates it by scanning the log.
+        findIndexEntry:
+            Finds the last index entry at or before a sequence number or
+            (boot, timestamp).
+        parseRecord:
+            Splits a log record line into its fields.
+******************************************************************************/
+
+#ifndef CUBESAT_FLIGHT_LOG_H
+#define CUBESAT_FLIGHT_LOG_H
+
+#include <cstdint>
+#include <string>
+#include "CubeSatLogStorage.h"
+
+// Combines a boot number and timestamp into a key ordered by time
+// across boots.
+inline uint64_t cubeSatLogTimeKey(uint32_t boot, uint32_t timestamp)
+{
+    return (static_cast<uint64_t>(boot) << 32) | timestamp;
+}
+
+struct CubeSatLogIndexEntry
+{
+    uint32_t boot = 0;
+    uint32_t sequence = 0;
+    uint32_t timestamp = 0;
+    uint32_t offset = 0;
+
+    // Size of an encoded entry in the index file.
+    static constexpr uint32_t ENCODED_SIZE = 16;
+
+    // Encodes the entry as little-endian bytes.
+    void encode(uint8_t* buffer) const;
+
+    // Decodes an entry from little-endian bytes.
+    static CubeSatLogIndexEntry decode(const uint8_t* buffer);
+};
+
+struct CubeSatLogRecord
+{
+    uint32_t boot = 0;
+    uint32_t sequence = 0;
+    uint32_t timestamp = 0;
+
+    // Module data stream, excluding the trailing newline.
+    const char* frame = nullptr;
+    size_t frameLength = 0;
+};
+
+class CubeSatFlightLog
+{
+    public:
+        static constexpr uint32_t DEFAULT_INDEX_INTERVAL = 4096;
+        static constexpr char RECORD_TERMINATOR = '\n';
+        static constexpr char FIELD_SEPARATOR = ',';
+
+        CubeSatFlightLog(CubeSatLogStorage* storage, const char* logPath,
+            const char* indexPath, uint32_t indexInterval = DEFAULT_INDEX_INTERVAL);
+        ~CubeSatFlightLog();
+
+        // Opens the log and index, recovering the sequence number and
+        // rebuilding the index if it is missing or inconsistent.
+        bool begin();
+
+        // Appends a record to the log, indexing it if required. The frame
+        // must not contain a record terminator. Returns false if the
+        // record could not be written in full.
+        bool append(uint32_t timestamp, const std::string& frame);
+
+        // Commits buffered log and index writes to storage.
+        void flush();
+
+        // Discards the index and regenerates it by scanning the log.
+        bool rebuildIndex();
+
+        // Finds the last index entry whose sequence number (or time key
+        // from cubeSatLogTimeKey, if byTimestamp is set) is at or before
+        // key. Falls back to the start of the log if every entry is after
+        // key or the index is broken.
+        bool findIndexEntry(uint64_t key, bool byTimestamp, CubeSatLogIndexEntry& entry);
+
+        // Splits a log record line, excluding its terminator, into its
+        // fields. Returns false if the line is malformed.
+        static bool parseRecord(const char* line, size_t length, CubeSatLogRecord& record);
+
+        // Getters
+        CubeSatLogStorage* getStorage();
+        const char* getLogPath();
+        uint32_t getLogSize();
+        uint32_t getNextSequence();
+        uint32_t getIndexEntryCount();
+        uint32_t getBoot();
+
+    private:
+        // Writes an index entry for a record starting at offset.
+        bool writeIndexEntry(uint32_t boot, uint32_t sequence, uint32_t timestamp, uint32_t offset);
+
+        // Ends a torn record so the next record starts on its own line.
+        bool terminateRecord();
+
+        // Walks the log from offset to the end, indexing records and
+        // advancing the sequence number as if they had just been appended.
+        bool scanLog(uint32_t offset);
+
+        // Closes the log and index files.
+        void close();
+
+        CubeSatLogStorage* storage;
+        const char* logPath;
+        const char* indexPath;
+        uint32_t indexInterval;
+
+        CubeSatLogFile* logFile = nullptr;
+        CubeSatLogFile* indexFile = nullptr;
+
+        uint32_t logSize = 0;
+        uint32_t nextSequence = 0;
+        uint32_t lastIndexedOffset = 0;
+        uint32_t indexEntryCount = 0;
+        uint32_t boot = 0;
+        uint32_t lastBoot = 0;
+        bool recordIsTorn = false;
+        bool indexIsBroken = false;
+};
+
+#endif
@@ -0,0 +1,349 @@
+// CubeSatLogExporter.cpp
+
+/******************************************************************************
+    CubeSatLogExporter Class Implementation
+
+    Purpose:
+        Handles serial export commands for the flight log. Uses the sparse
+        log index to seek straight to the first record of interest and
+        streams matching records to the sink in large writes.
+    Methods:
+        handleCommand:
+            Parses and executes a single command line.
+        exportRecords:
+            Streams records within a sequence or (boot, timestamp) range,
+            optionally cut down to a single device.
+        sendLines:
+            Sends lines framed like an export.
+    Helper Functions:
+        splitTokens:
+            Splits a command line on whitespace.
+        parseUnsigned:
+            Parses an unsigned decimal token.
+        findDeviceStream:
+            Finds a device's stream within a module data stream.
+******************************************************************************/
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "CubeSatLogExporter.h"
+#include "../CubeSatDataDiscriminators.h"
+
+// Size of the buffer used when reading the log.
+static constexpr size_t READ_BUFFER_SIZE = 1024;
+
+// Number of buffered output bytes that triggers a write to the sink.
+static constexpr size_t WRITE_BUFFER_SIZE = 1024;
+
+// Line starting a framed response.
+static const char* RESPONSE_HEADER = "BEGIN\n";
+
+// Prototypes
+std::vector<std::string> splitTokens(const std::string& command);
+bool parseUnsigned(const std::string& token, uint32_t& value);
+bool findDeviceStream(const CubeSatLogRecord& record, uint32_t device,
+    size_t& moduleIdLength, const char*& stream, size_t& streamLength);
+
+// Parses and executes a single command line.
+bool CubeSatLogExporter::handleCommand(const std::string& command)
+{
+    std::vector<std::string> tokens = splitTokens(command);
+    if (tokens.size() < 2 || tokens[0] != "EXPORT")
+    {
+        return reject("unknown command");
+    }
+
+    const std::string& mode = tokens[1];
+    if (mode == "ALL" && tokens.size() == 2)
+    {
+        return exportRecords(0, UINT32_MAX, false);
+    }
+
+    if (mode == "DEVICE" && tokens.size() == 3)
+    {
+        uint32_t device;
+        if (!parseUnsigned(tokens[2], device) || device > INT32_MAX)
+        {
+            return reject("invalid device");
+        }
+        return exportRecords(0, UINT32_MAX, false, static_cast<int>(device));
+    }
+
+    // Time ranges are preceded by the boot they fall within.
+    bool byTimestamp = mode == "TIME";
+    size_t rangeToken = byTimestamp ? 3 : 2;
+    if ((byTimestamp || mode == "SEQ")
+        && (tokens.size() == rangeToken + 2 || tokens.size() == rangeToken + 3))
+    {
+        uint32_t boot = 0;
+        if (byTimestamp && !parseUnsigned(tokens[2], boot))
+        {
+            return reject("invalid boot");
+        }
+
+        uint32_t start, end;
+        if (!parseUnsigned(tokens[rangeToken], start) || !parseUnsigned(tokens[rangeToken + 1], end)
+            || start > end)
+        {
+            return reject("invalid range");
+        }
+
+        uint32_t device = 0;
+        bool hasDevice = tokens.size() == rangeToken + 3;
+        if (hasDevice && (!parseUnsigned(tokens[rangeToken + 2], device) || device > INT32_MAX))
+        {
+            return reject("invalid device");
+        }
+
+        int exportDevice = hasDevice ? static_cast<int>(device) : ALL_DEVICES;
+        if (byTimestamp)
+        {
+            return exportRecords(cubeSatLogTimeKey(boot, start), cubeSatLogTimeKey(boot, end),
+                true, exportDevice);
+        }
+        return exportRecords(start, end, false, exportDevice);
+    }
+
+    return reject("invalid arguments");
+}
+
+// Streams records within a sequence or (boot, timestamp) range,
+// optionally cut down to a single device.
+bool CubeSatLogExporter::exportRecords(uint64_t start, uint64_t end, bool byTimestamp, int device)
+{
+    // Seek to the last indexed record at or before the start of the range.
+    CubeSatLogIndexEntry entry;
+    if (!log->findIndexEntry(start, byTimestamp, entry))
+    {
+        return reject("index unavailable");
+    }
+
+    CubeSatLogFile* logReader = log->getStorage()->open(log->getLogPath(), false);
+    if (!logReader)
+    {
+        return reject("log unavailable");
+    }
+    if (!logReader->seek(entry.offset))
+    {
+        delete logReader;
+        return reject("seek failed");
+    }
+
+    // Records appended while exporting are left for the next export.
+    uint32_t remaining = log->getLogSize() - entry.offset;
+
+    send(RESPONSE_HEADER);
+
+    std::string output;
+    output.reserve(WRITE_BUFFER_SIZE + READ_BUFFER_SIZE);
+    std::string partialLine;
+    uint32_t recordCount = 0;
+    uint32_t byteCount = 0;
+    bool pastEnd = false;
+    uint8_t buffer[READ_BUFFER_SIZE];
+
+    while (remaining > 0 && !pastEnd)
+    {
+        size_t bytesRead = logReader->read(buffer, remaining < sizeof(buffer) ? remaining : sizeof(buffer));
+        if (bytesRead == 0)
+        {
+            break;
+        }
+        remaining -= bytesRead;
+
+        const char* cursor = reinterpret_cast<const char*>(buffer);
+        const char* bufferEnd = cursor + bytesRead;
+        while (cursor < bufferEnd)
+        {
+            const char* terminator = static_cast<const char*>(
+                std::memchr(cursor, CubeSatFlightLog::RECORD_TERMINATOR, bufferEnd - cursor));
+            if (!terminator)
+            {
+                partialLine.append(cursor, bufferEnd);
+                break;
+            }
+
+            // Parse records straight out of the read buffer unless they
+            // straddle two reads.
+            const char* line = cursor;
+            size_t lineLength = terminator - cursor;
+            if (!partialLine.empty())
+            {
+                partialLine.append(cursor, terminator);
+                line = partialLine.data();
+                lineLength = partialLine.size();
+            }
+            cursor = terminator + 1;
+
+            CubeSatLogRecord record;
+            if (CubeSatFlightLog::parseRecord(line, lineLength, record))
+            {
+                uint64_t key = byTimestamp
+                    ? cubeSatLogTimeKey(record.boot, record.timestamp)
+                    : record.sequence;
+                if (key > end)
+                {
+                    pastEnd = true;
+                    break;
+                }
+                if (key >= start && device == ALL_DEVICES)
+                {
+                    output.append(line, lineLength);
+                    output += CubeSatFlightLog::RECORD_TERMINATOR;
+                    recordCount++;
+                }
+                else if (key >= start)
+                {
+                    // Keep the record fields and module ID, followed by
+                    // the device's stream as a module data stream.
+                    size_t moduleIdLength, streamLength;
+                    const char* stream;
+                    if (findDeviceStream(record, static_cast<uint32_t>(device), moduleIdLength, stream, streamLength))
+                    {
+                        output.append(line, record.frame + moduleIdLength + 1 - line);
+                        output.append(stream, streamLength);
+                        output += CubeSatDataDiscriminators::DEVICE_DISCRIMINATOR;
+                        output += CubeSatDataDiscriminators::MODULE_DISCRIMINATOR;
+                        output += CubeSatFlightLog::RECORD_TERMINATOR;
+                        recordCount++;
+                    }
+                }
+            }
+            partialLine.clear();
+
+            if (output.size() >= WRITE_BUFFER_SIZE)
+            {
+                byteCount += output.size();
+                send(output);
+                output.clear();
+            }
+        }
+    }
+    delete logReader;
+
+    byteCount += output.size();
+    send(output);
+    sendTrailer(recordCount, byteCount);
+    return true;
+}
+
+// Sends lines framed like an export, one record per line.
+void CubeSatLogExporter::sendLines(const std::vector<std::string>& lines)
+{
+    std::string output;
+    for (const std::string& line : lines)
+    {
+        output += line;
+        output += CubeSatFlightLog::RECORD_TERMINATOR;
+    }
+
+    send(RESPONSE_HEADER);
+    send(output);
+    sendTrailer(lines.size(), output.size());
+}
+
+// Writes an error response to the sink.
+bool CubeSatLogExporter::reject(const char* reason)
+{
+    send(std::string("ERR ") + reason + "\n");
+    return false;
+}
+
+// Writes data to the sink.
+void CubeSatLogExporter::send(const std::string& data)
+{
+    if (!data.empty())
+    {
+        sink->write(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    }
+}
+
+// Writes the trailer ending a framed response to the sink.
+void CubeSatLogExporter::sendTrailer(uint32_t recordCount, uint32_t byteCount)
+{
+    send("END " + std::to_string(recordCount) + " " + std::to_string(byteCount) + "\n");
+}
+
+// Splits a command line on whitespace.
+std::vector<std::string> splitTokens(const std::string& command)
+{
+    std::vector<std::string> tokens;
+    size_t position = 0;
+    while (position < command.size())
+    {
+        size_t tokenStart = command.find_first_not_of(" \t\r\n", position);
+        if (tokenStart == std::string::npos)
+        {
+            break;
+        }
+        size_t tokenEnd = command.find_first_of(" \t\r\n", tokenStart);
+        if (tokenEnd == std::string::npos)
+        {
+            tokenEnd = command.size();
+        }
+        tokens.push_back(command.substr(tokenStart, tokenEnd - tokenStart));
+        position = tokenEnd;
+    }
+    return tokens;
+}
+
+// Parses an unsigned decimal token.
+bool parseUnsigned(const std::string& token, uint32_t& value)
+{
+    if (token.empty() || token.find_first_not_of("0123456789") != std::string::npos)
+    {
+        return false;
+    }
+
+    unsigned long long parsed = std::strtoull(token.c_str(), nullptr, 10);
+    if (parsed > UINT32_MAX)
+    {
+        return false;
+    }
+    value = static_cast<uint32_t>(parsed);
+    return true;
+}
+
+// Finds a device's stream within a module data stream. Module data
+// streams are the module ID followed by each device's stream, each
+// ended by a device discriminator, then an optional latency trace and
+// a module discriminator. Returns false if the frame has no such device.
+bool findDeviceStream(const CubeSatLogRecord& record, uint32_t device,
+    size_t& moduleIdLength, const char*& stream, size_t& streamLength)
+{
+    const char* end = record.frame + record.frameLength;
+    const char* cursor = static_cast<const char*>(
+        std::memchr(record.frame, CubeSatDataDiscriminators::DEVICE_DISCRIMINATOR, record.frameLength));
+    if (!cursor || cursor == record.frame)
+    {
+        return false;
+    }
+    moduleIdLength = cursor - record.frame;
+
+    for (uint32_t index = 0; ; index++)
+    {
+        // Skip the discriminator ending the previous stream. A trace or
+        // the end of the module follows the last device.
+        cursor++;
+        if (cursor == end || *cursor == CubeSatDataDiscriminators::TRACE_DISCRIMINATOR
+            || *cursor == CubeSatDataDiscriminators::MODULE_DISCRIMINATOR)
+        {
+            return false;
+        }
+
+        const char* streamEnd = static_cast<const char*>(
+            std::memchr(cursor, CubeSatDataDiscriminators::DEVICE_DISCRIMINATOR, end - cursor));
+        if (!streamEnd)
+        {
+            return false;
+        }
+        if (index == device)
+        {
+            stream = cursor;
+            streamLength = streamEnd - cursor;
+            return true;
+        }
+        cursor = streamEnd;
+    }
+}
@@ -0,0 +1,94 @@
+// CubeSatLogExporter.h
+
+/******************************************************************************
+    CubeSatLogExporter Class Header
+
+    Purpose:
+        Handles serial export commands for the flight log. Uses the sparse
+        log index to seek straight to the first record of interest and
+        streams matching records to the sink in large writes.
+
+        Commands are single lines:
+            EXPORT ALL
+            EXPORT TIME <boot> <start> <end> [device]
+            EXPORT SEQ <start> <end> [device]
+            EXPORT DEVICE <device>
+        Ranges are inclusive. Timestamps restart on every boot, so a time
+        range is selected within a single boot, numbered as in the first
+        field of each record. A device is selected by its position in the
+        module data stream, counting from 0. Each record is then cut down
+        to that device's stream:
+            <boot>,<sequence>,<timestamp>,<moduleId>:<device stream>:;
+        and records without the device are skipped. Statistics records
+        (POWER, WAKEUP, LATENCY) are exported by ALL, SEQ and TIME but
+        never have a device. A successful export is framed as:
+            BEGIN\n<records>END <record count> <byte count>\n
+        Other multi-line responses, such as the current statistics lines
+        sent in reply to STATS, use the same framing with a line per
+        record. A rejected command is answered with:
+            ERR <reason>\n
+        A module in light sleep is woken by serial input but loses the
+        first characters it receives, and the line they start is ignored
+        without a reply. Send a throwaway wake line (e.g. an empty line)
+        first, which keeps the module awake for a few seconds, and retry
+        a command that gets no reply. Blank lines are never answered.
+    Attributes:
+        log:    CubeSatFlightLog* - Flight log to export from.
+        sink:   CubeSatLogSink*   - Destination for exported records.
+    Methods:
+        handleCommand:
+            Parses and executes a single command line.
+        exportRecords:
+            Streams records within a sequence or (boot, timestamp) range,
+            optionally cut down to a single device.
+        sendLines:
+            Sends lines framed like an export.
+******************************************************************************/
+
+#ifndef CUBESAT_LOG_EXPORTER_H
+#define CUBESAT_LOG_EXPORTER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CubeSatFlightLog.h"
+#include "CubeSatLogStorage.h"
+
+class CubeSatLogExporter
+{
+    public:
+        // Device index used to export whole records.
+        static constexpr int ALL_DEVICES = -1;
+
+        CubeSatLogExporter(CubeSatFlightLog* log, CubeSatLogSink* sink)
+            : log(log), sink(sink) {}
+
+        // Parses and executes a single command line. Returns false if
+        // the command was rejected or the export failed.
+        bool handleCommand(const std::string& command);
+
+        // Streams records whose sequence number (or time key from
+        // cubeSatLogTimeKey, if byTimestamp is set) is within
+        // [start, end], optionally cut down to a single device.
+        bool exportRecords(uint64_t start, uint64_t end, bool byTimestamp,
+            int device = ALL_DEVICES);
+
+        // Sends lines framed like an export, one record per line. Lines
+        // must not contain a record terminator.
+        void sendLines(const std::vector<std::string>& lines);
+
+    private:
+        // Writes an error response to the sink.
+        bool reject(const char* reason);
+
+        // Writes data to the sink.
+        void send(const std::string& data);
+
+        // Writes the trailer ending a framed response to the sink.
+        void sendTrailer(uint32_t recordCount, uint32_t byteCount);
+
+        CubeSatFlightLog* log;
+        CubeSatLogSink* sink;
+};
+
+#endif
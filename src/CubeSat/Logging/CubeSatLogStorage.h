@@ -0,0 +1,73 @@
+// CubeSatLogStorage.h
+
+/******************************************************************************
+    Log Storage Interfaces
+
+    Purpose:
+        Abstracts the storage medium and serial output used by the flight
+        log so the logging and export code does not depend on the SD or
+        Serial libraries directly. The SD card implementation lives in
+        CubeSatSdLogStorage; any file-backed stand-in can be substituted.
+    Classes:
+        CubeSatLogFile:
+            An open file supporting sequential reads, seeking and appending.
+        CubeSatLogStorage:
+            Opens and removes files on the storage medium.
+        CubeSatLogSink:
+            Destination for exported log data (e.g. the serial port).
+******************************************************************************/
+
+#ifndef CUBESAT_LOG_STORAGE_H
+#define CUBESAT_LOG_STORAGE_H
+
+#include <cstddef>
+#include <cstdint>
+
+class CubeSatLogFile
+{
+    public:
+        virtual ~CubeSatLogFile() {}
+
+        // Returns the size of the file in bytes.
+        virtual uint32_t size() = 0;
+
+        // Moves the read position to the given byte offset.
+        virtual bool seek(uint32_t position) = 0;
+
+        // Reads up to length bytes into buffer. Returns the number of
+        // bytes read, or 0 at the end of the file.
+        virtual size_t read(uint8_t* buffer, size_t length) = 0;
+
+        // Appends length bytes to the end of the file. Returns the
+        // number of bytes written.
+        virtual size_t write(const uint8_t* buffer, size_t length) = 0;
+
+        // Commits buffered writes to the storage medium.
+        virtual void flush() = 0;
+};
+
+class CubeSatLogStorage
+{
+    public:
+        virtual ~CubeSatLogStorage() {}
+
+        // Opens a file for reading, or for appending if append is set.
+        // Returns nullptr if the file could not be opened. The caller
+        // owns the returned file.
+        virtual CubeSatLogFile* open(const char* path, bool append) = 0;
+
+        // Deletes a file. Returns true if the file no longer exists.
+        virtual bool remove(const char* path) = 0;
+};
+
+class CubeSatLogSink
+{
+    public:
+        virtual ~CubeSatLogSink() {}
+
+        // Writes length bytes to the sink. Returns the number of bytes
+        // written.
+        virtual size_t write(const uint8_t* buffer, size_t length) = 0;
+};
+
+#endif
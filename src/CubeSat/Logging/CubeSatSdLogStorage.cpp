@@ -0,0 +1,66 @@
+// CubeSatSdLogStorage.cpp
+
+/******************************************************************************
+    SD Card Log Storage Implementation
+
+    Purpose:
+        CubeSatLogStorage implementation backed by the SD card, plus a
+        CubeSatLogSink that writes to an Arduino stream such as Serial.
+******************************************************************************/
+
+#include "CubeSatSdLogStorage.h"
+
+CubeSatSdLogFile::~CubeSatSdLogFile()
+{
+    file.close();
+}
+
+uint32_t CubeSatSdLogFile::size()
+{
+    return file.size();
+}
+
+bool CubeSatSdLogFile::seek(uint32_t position)
+{
+    return file.seek(position);
+}
+
+size_t CubeSatSdLogFile::read(uint8_t* buffer, size_t length)
+{
+    int bytesRead = file.read(buffer, length);
+    return bytesRead < 0 ? 0 : static_cast<size_t>(bytesRead);
+}
+
+size_t CubeSatSdLogFile::write(const uint8_t* buffer, size_t length)
+{
+    return file.write(buffer, length);
+}
+
+void CubeSatSdLogFile::flush()
+{
+    file.flush();
+}
+
+CubeSatLogFile* CubeSatSdLogStorage::open(const char* path, bool append)
+{
+    File file = SD.open(path, append ? FILE_APPEND : FILE_READ);
+    if (!file)
+    {
+        return nullptr;
+    }
+    return new CubeSatSdLogFile(file);
+}
+
+bool CubeSatSdLogStorage::remove(const char* path)
+{
+    if (!SD.exists(path))
+    {
+        return true;
+    }
+    return SD.remove(path);
+}
+
+size_t CubeSatStreamLogSink::write(const uint8_t* buffer, size_t length)
+{
+    return stream->write(buffer, length);
+}
@@ -0,0 +1,60 @@
+// CubeSatSdLogStorage.h
+
+/******************************************************************************
+    SD Card Log Storage Header
+
+    Purpose:
+        CubeSatLogStorage implementation backed by the SD card, plus a
+        CubeSatLogSink that writes to an Arduino stream such as Serial.
+    Classes:
+        CubeSatSdLogFile:
+            Wraps an open SD card file.
+        CubeSatSdLogStorage:
+            Opens and removes files on the SD card. The SD card must
+            already be initialized.
+        CubeSatStreamLogSink:
+            Writes exported log data to an Arduino Stream.
+******************************************************************************/
+
+#ifndef CUBESAT_SD_LOG_STORAGE_H
+#define CUBESAT_SD_LOG_STORAGE_H
+
+#include <SD.h>
+#include <Arduino.h>
+#include "CubeSatLogStorage.h"
+
+class CubeSatSdLogFile : public CubeSatLogFile
+{
+    public:
+        CubeSatSdLogFile(File file) : file(file) {}
+        virtual ~CubeSatSdLogFile();
+
+        virtual uint32_t size();
+        virtual bool seek(uint32_t position);
+        virtual size_t read(uint8_t* buffer, size_t length);
+        virtual size_t write(const uint8_t* buffer, size_t length);
+        virtual void flush();
+
+    private:
+        File file;
+};
+
+class CubeSatSdLogStorage : public CubeSatLogStorage
+{
+    public:
+        virtual CubeSatLogFile* open(const char* path, bool append);
+        virtual bool remove(const char* path);
+};
+
+class CubeSatStreamLogSink : public CubeSatLogSink
+{
+    public:
+        CubeSatStreamLogSink(Stream* stream) : stream(stream) {}
+
+        virtual size_t write(const uint8_t* buffer, size_t length);
+
+    private:
+        Stream* stream;
+};
+
+#endif
@@ -0,0 +1,205 @@
+// CubeSatDutyCycle.cpp
+
+/******************************************************************************
+    CubeSatDutyCycle Class Implementation
+
+    Purpose:
+        Puts the module into the lowest power state that still lets it
+        service its next deadline on time.
+    Methods:
+        beginCycle:
+            Starts collecting deadlines for a pass through the main loop.
+        addDeadline:
+            Adds a time at which something needs service.
+        addDeadlineIn:
+            Adds a deadline relative to the current time.
+        chooseState:
+            Returns the power state used to wait out a gap.
+        waitForDeadline:
+            Waits for the earliest deadline in the chosen power state.
+        getPowerReport:
+            Summarizes the time in each power state and the wakeup
+            statistics.
+******************************************************************************/
+
+#include "CubeSatDutyCycle.h"
+
+CubeSatDutyCycle::CubeSatDutyCycle(CubeSatClock* clock, CubeSatPowerControl* power,
+    CubeSatDutyCycleConfig config)
+    : clock(clock), power(power), config(config)
+{
+    // Time before the first wait, including boot, counts as active.
+    wakeupMargin = config.minWakeupMargin;
+    lastWake = 0;
+    for (int state = 0; state < POWER_STATE_COUNT; state++)
+    {
+        stateTimes[state] = 0;
+    }
+}
+
+// Starts collecting deadlines for a pass through the main loop.
+void CubeSatDutyCycle::beginCycle()
+{
+    deadline = clock->micros() + config.maxWait;
+    sleepAllowed = true;
+}
+
+// Adds a clock time at which something needs service.
+void CubeSatDutyCycle::addDeadline(uint32_t deadline)
+{
+    // Times wrap, so they are compared by signed difference.
+    if (static_cast<int32_t>(deadline - this->deadline) < 0)
+    {
+        this->deadline = deadline;
+    }
+}
+
+// Adds a deadline remaining microseconds from now.
+void CubeSatDutyCycle::addDeadlineIn(int32_t remaining)
+{
+    addDeadline(clock->micros() + (remaining > 0 ? remaining : 0));
+}
+
+// Allows or prevents light sleep this cycle.
+void CubeSatDutyCycle::setSleepAllowed(bool sleepAllowed)
+{
+    this->sleepAllowed = sleepAllowed;
+}
+
+// Returns the power state used to wait out a gap.
+CubeSatDutyCycle::PowerState CubeSatDutyCycle::chooseState(uint32_t gap)
+{
+    if (gap == 0)
+    {
+        return ACTIVE;
+    }
+
+    // Light sleep must leave time after its wakeup margin to be worth
+    // the cost of entering it.
+    if (sleepAllowed && gap >= config.lightSleepThreshold && gap > 2 * wakeupMargin)
+    {
+        return LIGHT_SLEEP;
+    }
+    return gap < config.lowFrequencyThreshold ? IDLE : LOW_FREQUENCY_IDLE;
+}
+
+// Waits for the earliest deadline in the chosen power state.
+CubeSatDutyCycle::PowerState CubeSatDutyCycle::waitForDeadline()
+{
+    uint32_t now = clock->micros();
+    accountTime(ACTIVE, now);
+
+    int32_t remaining = static_cast<int32_t>(deadline - now);
+    PowerState state = chooseState(remaining > 0 ? remaining : 0);
+    wokeEarly = false;
+
+    switch (state)
+    {
+        case ACTIVE:
+            return state;
+
+        case IDLE:
+            power->idle(remaining);
+            break;
+
+        case LOW_FREQUENCY_IDLE:
+        {
+            // Switching frequency takes time, so re-measure what is left.
+            power->setCpuFrequency(config.lowFrequency);
+            remaining = static_cast<int32_t>(deadline - clock->micros());
+            if (remaining > 0)
+            {
+                power->idle(remaining);
+            }
+            power->setCpuFrequency(config.activeFrequency);
+            break;
+        }
+
+        case LIGHT_SLEEP:
+        {
+            uint32_t sleepEnd = deadline - wakeupMargin;
+            power->lightSleep(sleepEnd - now);
+
+            // Waking well ahead of the timer means another wakeup source
+            // (e.g. serial input) needs service now.
+            int32_t wakeupLatency = static_cast<int32_t>(clock->micros() - sleepEnd);
+            if (wakeupLatency < -static_cast<int32_t>(config.minWakeupMargin))
+            {
+                wokeEarly = true;
+                earlyWakeups++;
+                break;
+            }
+
+            // Raise the margin straight away after a late wakeup, and
+            // lower it slowly after early ones.
+            uint32_t targetMargin = config.minWakeupMargin + (wakeupLatency > 0 ? wakeupLatency : 0);
+            if (targetMargin > wakeupMargin)
+            {
+                wakeupMargin = targetMargin;
+            }
+            else
+            {
+                wakeupMargin -= (wakeupMargin - targetMargin) / 8;
+            }
+
+            // Idle out whatever is left of the margin.
+            remaining = static_cast<int32_t>(deadline - clock->micros());
+            if (remaining > 0)
+            {
+                power->idle(remaining);
+            }
+            break;
+        }
+
+        default:
+            return ACTIVE;
+    }
+
+    uint32_t wake = clock->micros();
+    accountTime(state, wake);
+
+    if (!wokeEarly)
+    {
+        int32_t late = static_cast<int32_t>(wake - deadline);
+        if (late > static_cast<int32_t>(config.lateTolerance))
+        {
+            lateWakeups++;
+        }
+        overshoot.record(late > 0 ? late : 0);
+    }
+    return state;
+}
+
+// Summarizes the time in each power state and the wakeup statistics.
+std::vector<std::string> CubeSatDutyCycle::getPowerReport()
+{
+    std::string power = "POWER";
+    for (int state = 0; state < POWER_STATE_COUNT; state++)
+    {
+        power += "," + std::to_string(stateTimes[state]);
+    }
+
+    std::string wakeup = "WAKEUP," + std::to_string(lateWakeups)
+        + "," + std::to_string(earlyWakeups)
+        + "," + std::to_string(wakeupMargin)
+        + "," + overshoot.formatSummary();
+    return { power, wakeup };
+}
+
+// Getters
+uint64_t CubeSatDutyCycle::getTimeInState(PowerState state)
+{
+    return state < POWER_STATE_COUNT ? stateTimes[state] : 0;
+}
+CubeSatLatencyStats* CubeSatDutyCycle::getOvershoot() { return &this->overshoot; }
+uint32_t CubeSatDutyCycle::getLateWakeups() { return this->lateWakeups; }
+uint32_t CubeSatDutyCycle::getEarlyWakeups() { return this->earlyWakeups; }
+bool CubeSatDutyCycle::getWokeEarly() { return this->wokeEarly; }
+uint32_t CubeSatDutyCycle::getWakeupMargin() { return this->wakeupMargin; }
+
+// Adds the time since the last wait ended to a power state.
+void CubeSatDutyCycle::accountTime(PowerState state, uint32_t now)
+{
+    stateTimes[state] += now - lastWake;
+    lastWake = now;
+}
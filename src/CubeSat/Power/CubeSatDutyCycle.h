@@ -0,0 +1,161 @@
+// CubeSatDutyCycle.h
+
+/******************************************************************************
+    CubeSatDutyCycle Class Header
+
+    Purpose:
+        Puts the module into the lowest power state that still lets it
+        service its next deadline on time. Each pass through the main loop
+        collects the deadlines of everything needing service (device
+        samples, data stream refreshes, log flushes, transmit slots) and
+        then waits for the earliest one:
+            - Short gaps idle at full clock.
+            - Medium gaps idle with the CPU clock scaled down.
+            - Long gaps enter light sleep, waking on a timer ahead of the
+              deadline by a margin learned from previous wakeups, then idle
+              out the remainder.
+        Wakeup overshoot past each deadline and the time spent in each
+        power state are recorded.
+    Attributes:
+        clock:          CubeSatClock*        - Monotonic microsecond clock.
+        power:          CubeSatPowerControl* - Power controls.
+        config:         CubeSatDutyCycleConfig - Thresholds and frequencies.
+        deadline:       uint32_t             - Earliest deadline this cycle.
+        sleepAllowed:   bool                 - Whether light sleep may be
+                                               used this cycle.
+        wakeupMargin:   uint32_t             - Time light sleep ends ahead
+                                               of the deadline.
+        lastWake:       uint32_t             - Time the last wait ended.
+        stateTimes:     uint64_t[]           - Microseconds spent in each
+                                               power state.
+        overshoot:      CubeSatLatencyStats  - Rolling wakeup overshoot.
+        lateWakeups:    uint32_t             - Waits that overshot their
+                                               deadline by more than the
+                                               late tolerance.
+        earlyWakeups:   uint32_t             - Light sleeps ended early by
+                                               another wakeup source.
+        wokeEarly:      bool                 - Whether the last wait was
+                                               ended early by another
+                                               wakeup source.
+    Methods:
+        beginCycle:
+            Starts collecting deadlines for a pass through the main loop.
+        addDeadline:
+            Adds a time at which something needs service.
+        addDeadlineIn:
+            Adds a deadline relative to the current time.
+        chooseState:
+            Returns the power state used to wait out a gap.
+        waitForDeadline:
+            Waits for the earliest deadline in the chosen power state.
+        getPowerReport:
+            Summarizes the time in each power state and the wakeup
+            statistics.
+******************************************************************************/
+
+#ifndef CUBESAT_DUTY_CYCLE_H
+#define CUBESAT_DUTY_CYCLE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CubeSatPowerControl.h"
+#include "../Timing/CubeSatClock.h"
+#include "../Timing/CubeSatLatencyStats.h"
+
+struct CubeSatDutyCycleConfig
+{
+    // Gaps shorter than this idle at full clock, in microseconds.
+    uint32_t lowFrequencyThreshold = 2000;
+
+    // Gaps at least this long use light sleep, in microseconds.
+    uint32_t lightSleepThreshold = 20000;
+
+    // Longest wait before the main loop runs again, in microseconds.
+    uint32_t maxWait = 1000000;
+
+    // Initial and minimum light sleep wakeup margin, in microseconds.
+    uint32_t minWakeupMargin = 500;
+
+    // Overshoot past a deadline counted as a late wakeup, in microseconds.
+    uint32_t lateTolerance = 1000;
+
+    // CPU frequencies while active and while idling at low clock.
+    uint32_t activeFrequency = 240;
+    uint32_t lowFrequency = 80;
+};
+
+class CubeSatDutyCycle
+{
+    public:
+        enum PowerState
+        {
+            ACTIVE,
+            IDLE,
+            LOW_FREQUENCY_IDLE,
+            LIGHT_SLEEP,
+            POWER_STATE_COUNT
+        };
+
+        CubeSatDutyCycle(CubeSatClock* clock, CubeSatPowerControl* power,
+            CubeSatDutyCycleConfig config = CubeSatDutyCycleConfig());
+
+        // Starts collecting deadlines for a pass through the main loop.
+        void beginCycle();
+
+        // Adds a clock time at which something needs service. The
+        // earliest deadline added this cycle is waited for.
+        void addDeadline(uint32_t deadline);
+
+        // Adds a deadline remaining microseconds from now. Overdue
+        // deadlines may be given as negative.
+        void addDeadlineIn(int32_t remaining);
+
+        // Allows or prevents light sleep this cycle.
+        void setSleepAllowed(bool sleepAllowed);
+
+        // Returns the power state used to wait out a gap.
+        PowerState chooseState(uint32_t gap);
+
+        // Waits for the earliest deadline in the chosen power state.
+        // Returns the state used.
+        PowerState waitForDeadline();
+
+        // Summarizes the duty cycle as two lines:
+        //     POWER,<active>,<idle>,<low frequency idle>,<light sleep>
+        //     WAKEUP,<late>,<early>,<margin>,<count>,<p50>,<p90>,<p99>,<max>
+        // POWER gives the microseconds spent in each state since boot.
+        // WAKEUP gives the late and early wakeup counts, the current
+        // wakeup margin and the rolling overshoot percentiles, in
+        // microseconds.
+        std::vector<std::string> getPowerReport();
+
+        // Getters
+        uint64_t getTimeInState(PowerState state);
+        CubeSatLatencyStats* getOvershoot();
+        uint32_t getLateWakeups();
+        uint32_t getEarlyWakeups();
+        bool getWokeEarly();
+        uint32_t getWakeupMargin();
+
+    private:
+        // Adds the time since the last wait ended to a power state.
+        void accountTime(PowerState state, uint32_t now);
+
+        CubeSatClock* clock;
+        CubeSatPowerControl* power;
+        CubeSatDutyCycleConfig config;
+
+        uint32_t deadline = 0;
+        bool sleepAllowed = true;
+        uint32_t wakeupMargin;
+        uint32_t lastWake;
+
+        uint64_t stateTimes[POWER_STATE_COUNT];
+        CubeSatLatencyStats overshoot;
+        uint32_t lateWakeups = 0;
+        uint32_t earlyWakeups = 0;
+        bool wokeEarly = false;
+};
+
+#endif
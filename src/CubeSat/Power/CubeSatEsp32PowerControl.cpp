@@ -0,0 +1,51 @@
+// CubeSatEsp32PowerControl.cpp
+
+/******************************************************************************
+    CubeSatEsp32PowerControl Class Implementation
+
+    Purpose:
+        CubeSatPowerControl implementation for the ESP32.
+******************************************************************************/
+
+#include <esp_sleep.h>
+#include <driver/uart.h>
+#include "CubeSatEsp32PowerControl.h"
+
+// Number of UART edges needed to wake from light sleep. The characters
+// that wake the module are lost.
+static constexpr int UART_WAKEUP_THRESHOLD = 3;
+
+// Enables the serial port as a light sleep wakeup source.
+void CubeSatEsp32PowerControl::begin()
+{
+    uart_set_wakeup_threshold(UART_NUM_0, UART_WAKEUP_THRESHOLD);
+    esp_sleep_enable_uart_wakeup(UART_NUM_0);
+}
+
+// Waits without entering a sleep mode, yielding to other tasks.
+void CubeSatEsp32PowerControl::idle(uint32_t duration)
+{
+    if (duration >= 1000)
+    {
+        delay(duration / 1000);
+    }
+    delayMicroseconds(duration % 1000);
+}
+
+// Enters light sleep, waking on a timer.
+void CubeSatEsp32PowerControl::lightSleep(uint32_t duration)
+{
+    // Pending output is lost if the UART is stopped mid-transmission.
+    serial->flush();
+    esp_sleep_enable_timer_wakeup(duration);
+    esp_light_sleep_start();
+}
+
+// Changes the CPU clock frequency.
+void CubeSatEsp32PowerControl::setCpuFrequency(uint32_t megahertz)
+{
+    if (getCpuFrequencyMhz() != megahertz)
+    {
+        setCpuFrequencyMhz(megahertz);
+    }
+}
@@ -0,0 +1,46 @@
+// CubeSatEsp32PowerControl.h
+
+/******************************************************************************
+    CubeSatEsp32PowerControl Class Header
+
+    Purpose:
+        CubeSatPowerControl implementation for the ESP32. Light sleep wakes
+        on a timer or on activity on the serial port's UART, so log export
+        commands can wake the module.
+    Attributes:
+        serial:     HardwareSerial* - Serial port flushed before sleeping and
+                                      used as a wakeup source.
+    Methods:
+        begin:
+            Enables the serial port as a light sleep wakeup source.
+        idle:
+            Waits without entering a sleep mode, yielding to other tasks.
+        lightSleep:
+            Enters light sleep, waking on a timer.
+        setCpuFrequency:
+            Changes the CPU clock frequency.
+******************************************************************************/
+
+#ifndef CUBESAT_ESP32_POWER_CONTROL_H
+#define CUBESAT_ESP32_POWER_CONTROL_H
+
+#include <Arduino.h>
+#include "CubeSatPowerControl.h"
+
+class CubeSatEsp32PowerControl : public CubeSatPowerControl
+{
+    public:
+        CubeSatEsp32PowerControl(HardwareSerial* serial) : serial(serial) {}
+
+        // Enables the serial port as a light sleep wakeup source.
+        void begin();
+
+        virtual void idle(uint32_t duration);
+        virtual void lightSleep(uint32_t duration);
+        virtual void setCpuFrequency(uint32_t megahertz);
+
+    private:
+        HardwareSerial* serial;
+};
+
+#endif
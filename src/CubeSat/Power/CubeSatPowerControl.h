@@ -0,0 +1,40 @@
+// CubeSatPowerControl.h
+
+/******************************************************************************
+    CubeSatPowerControl Interface
+
+    Purpose:
+        Abstracts the module's power controls so the duty-cycle decision
+        logic can run against a simulated clock off-target. The ESP32
+        implementation lives in CubeSatEsp32PowerControl.
+    Methods:
+        idle:
+            Virtual method to wait without entering a sleep mode.
+        lightSleep:
+            Virtual method to enter light sleep, waking on a timer.
+        setCpuFrequency:
+            Virtual method to change the CPU clock frequency.
+******************************************************************************/
+
+#ifndef CUBESAT_POWER_CONTROL_H
+#define CUBESAT_POWER_CONTROL_H
+
+#include <cstdint>
+
+class CubeSatPowerControl
+{
+    public:
+        virtual ~CubeSatPowerControl() {}
+
+        // Waits for duration microseconds without entering a sleep mode.
+        virtual void idle(uint32_t duration) = 0;
+
+        // Enters light sleep, waking on a timer after duration
+        // microseconds or earlier on another wakeup source.
+        virtual void lightSleep(uint32_t duration) = 0;
+
+        // Changes the CPU clock frequency.
+        virtual void setCpuFrequency(uint32_t megahertz) = 0;
+};
+
+#endif
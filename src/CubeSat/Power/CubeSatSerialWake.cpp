@@ -0,0 +1,69 @@
+// CubeSatSerialWake.cpp
+
+/******************************************************************************
+    CubeSatSerialWake Class Implementation
+
+    Purpose:
+        Keeps serial commands working across light sleep.
+    Methods:
+        noteInput:
+            Records serial input.
+        noteWakeup:
+            Records a wakeup by serial input.
+        isSleepAllowed:
+            Returns whether light sleep may be used.
+        acceptLine:
+            Returns whether a received line should be handled.
+******************************************************************************/
+
+#include "CubeSatSerialWake.h"
+
+// Records serial input received at now.
+void CubeSatSerialWake::noteInput(unsigned long now)
+{
+    lastActivity = now;
+}
+
+// Records that serial input woke the module from light sleep at now.
+void CubeSatSerialWake::noteWakeup(unsigned long now)
+{
+    // The characters that woke the module are lost, so the wakeup itself
+    // starts the hold-off. Otherwise a wake line that never arrives would
+    // let the module sleep straight away and drop the command after it.
+    lastActivity = now;
+    awaitingWakeLine = true;
+}
+
+// Returns whether light sleep may be used at now.
+bool CubeSatSerialWake::isSleepAllowed(unsigned long now)
+{
+    return now - lastActivity >= awakeInterval;
+}
+
+// Returns whether a received line should be handled.
+bool CubeSatSerialWake::acceptLine(const std::string& line)
+{
+    bool awaitingWakeLine = this->awaitingWakeLine;
+    this->awaitingWakeLine = false;
+
+    size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string::npos)
+    {
+        return false;
+    }
+    if (!awaitingWakeLine)
+    {
+        return true;
+    }
+
+    // The first line after a wakeup is missing its start unless it still
+    // begins with a command.
+    for (const std::string& command : commands)
+    {
+        if (line.compare(start, command.size(), command) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,72 @@
+// CubeSatSerialWake.h
+
+/******************************************************************************
+    CubeSatSerialWake Class Header
+
+    Purpose:
+        Keeps serial commands working across light sleep. Serial input
+        wakes the module, but the characters that wake it are dropped, so
+        the line they start arrives without its beginning (or not at all,
+        if it was a short wake line). After a wakeup or any other input,
+        light sleep is held off for awakeInterval so the rest of a command
+        arrives intact, and the first line after a wakeup is ignored unless
+        it still begins with a known command.
+    Attributes:
+        commands:           vector<string> - Keywords starting every
+                                             serial command.
+        awakeInterval:      unsigned long  - Milliseconds to stay out of
+                                             light sleep after serial
+                                             activity.
+        lastActivity:       unsigned long  - Time of the most recent serial
+                                             input or wakeup.
+        awaitingWakeLine:   bool           - Whether the next line may be
+                                             missing its start.
+    Methods:
+        noteInput:
+            Records serial input.
+        noteWakeup:
+            Records a wakeup by serial input.
+        isSleepAllowed:
+            Returns whether light sleep may be used.
+        acceptLine:
+            Returns whether a received line should be handled.
+******************************************************************************/
+
+#ifndef CUBESAT_SERIAL_WAKE_H
+#define CUBESAT_SERIAL_WAKE_H
+
+#include <string>
+#include <vector>
+
+class CubeSatSerialWake
+{
+    public:
+        static constexpr unsigned long DEFAULT_AWAKE_INTERVAL_MS = 5000;
+
+        CubeSatSerialWake(std::vector<std::string> commands,
+            unsigned long awakeInterval = DEFAULT_AWAKE_INTERVAL_MS)
+            : commands(commands), awakeInterval(awakeInterval) {}
+
+        // Records serial input received at now, in milliseconds.
+        void noteInput(unsigned long now);
+
+        // Records that serial input woke the module from light sleep at
+        // now, in milliseconds. The input itself may never be received.
+        void noteWakeup(unsigned long now);
+
+        // Returns whether light sleep may be used at now, in milliseconds.
+        bool isSleepAllowed(unsigned long now);
+
+        // Returns whether a received line, excluding its terminator,
+        // should be handled. Blank lines and the line after a wakeup,
+        // unless it begins with a command, are ignored.
+        bool acceptLine(const std::string& line);
+
+    private:
+        std::vector<std::string> commands;
+        unsigned long awakeInterval;
+        unsigned long lastActivity = 0;
+        bool awaitingWakeLine = false;
+};
+
+#endif
@@ -0,0 +1,16 @@
+// CubeSatArduinoClock.cpp
+
+/******************************************************************************
+    CubeSatArduinoClock Class Implementation
+
+    Purpose:
+        CubeSatClock implementation backed by the Arduino micros() timer.
+******************************************************************************/
+
+#include <Arduino.h>
+#include "CubeSatArduinoClock.h"
+
+uint32_t CubeSatArduinoClock::micros()
+{
+    return ::micros();
+}
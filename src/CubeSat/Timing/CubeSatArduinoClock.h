@@ -0,0 +1,21 @@
+// CubeSatArduinoClock.h
+
+/******************************************************************************
+    CubeSatArduinoClock Class Header
+
+    Purpose:
+        CubeSatClock implementation backed by the Arduino micros() timer.
+******************************************************************************/
+
+#ifndef CUBESAT_ARDUINO_CLOCK_H
+#define CUBESAT_ARDUINO_CLOCK_H
+
+#include "CubeSatClock.h"
+
+class CubeSatArduinoClock : public CubeSatClock
+{
+    public:
+        virtual uint32_t micros();
+};
+
+#endif
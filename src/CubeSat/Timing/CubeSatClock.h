@@ -0,0 +1,30 @@
+// CubeSatClock.h
+
+/******************************************************************************
+    CubeSatClock Interface
+
+    Purpose:
+        Abstracts the module's monotonic clock so timing-dependent code can
+        run against a simulated clock off-target. Times are microseconds
+        since boot and wrap every 2^32 microseconds (about 71 minutes), so
+        callers compare times by unsigned difference.
+    Methods:
+        micros:
+            Virtual method returning the current time in microseconds.
+******************************************************************************/
+
+#ifndef CUBESAT_CLOCK_H
+#define CUBESAT_CLOCK_H
+
+#include <cstdint>
+
+class CubeSatClock
+{
+    public:
+        virtual ~CubeSatClock() {}
+
+        // Returns the current time in microseconds.
+        virtual uint32_t micros() = 0;
+};
+
+#endif
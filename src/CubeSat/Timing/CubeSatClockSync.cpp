@@ -0,0 +1,155 @@
+// CubeSatClockSync.cpp
+
+/******************************************************************************
+    CubeSatClockSync Class Implementation
+
+    Purpose:
+        Estimates the mapping from a module's clock to the hub's clock from
+        the lower envelope of one-way timestamp deltas.
+    Methods:
+        observe:
+            Adds a module/hub timestamp pair for the same event.
+        toHubTime:
+            Converts a module time to an estimated hub time.
+        isSynchronized:
+            Returns whether any observation has been made.
+        getSkew:
+            Returns the estimated skew in parts per million.
+        fitMinimums:
+            Fits the skew and anchor to the recent window minimums.
+******************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include "CubeSatClockSync.h"
+
+// Adds a module/hub timestamp pair for the same event.
+void CubeSatClockSync::observe(uint32_t moduleTime, uint32_t hubTime)
+{
+    // Deltas wrap with the clocks, so they are compared by signed
+    // difference. The expected drift since the window's minimum is taken
+    // out so the window keeps its least delayed observation rather than
+    // its earliest or latest.
+    uint32_t delta = hubTime - moduleTime;
+    int32_t drift = static_cast<int32_t>(std::lround(skew * static_cast<int32_t>(moduleTime - windowTime)));
+    if (windowCount == 0 || static_cast<int32_t>(delta - windowDelta) < drift)
+    {
+        windowDelta = delta;
+        windowTime = moduleTime;
+    }
+
+    if (++windowCount < WINDOW_SIZE)
+    {
+        return;
+    }
+
+    // Keep the most recent window minimums, dropping the oldest.
+    if (minimumCount == FIT_WINDOWS)
+    {
+        for (int i = 1; i < FIT_WINDOWS; i++)
+        {
+            minimumTimes[i - 1] = minimumTimes[i];
+            minimumDeltas[i - 1] = minimumDeltas[i];
+        }
+        minimumCount--;
+    }
+    minimumTimes[minimumCount] = windowTime;
+    minimumDeltas[minimumCount] = windowDelta;
+    minimumCount++;
+
+    fitMinimums();
+    windowCount = 0;
+}
+
+// Converts a module time to an estimated hub time.
+uint32_t CubeSatClockSync::toHubTime(uint32_t moduleTime)
+{
+    if (!hasAnchor)
+    {
+        return moduleTime + windowDelta;
+    }
+
+    uint32_t delta = predictDelta(moduleTime);
+
+    // A smaller delta in the current window means the prediction has
+    // fallen behind, so shift it down to the observed envelope.
+    if (windowCount > 0)
+    {
+        int32_t correction = static_cast<int32_t>(windowDelta - predictDelta(windowTime));
+        if (correction < 0)
+        {
+            delta += correction;
+        }
+    }
+
+    return moduleTime + delta;
+}
+
+// Returns whether any observation has been made.
+bool CubeSatClockSync::isSynchronized()
+{
+    return hasAnchor || windowCount > 0;
+}
+
+// Returns the estimated skew in parts per million.
+double CubeSatClockSync::getSkew()
+{
+    return skew * 1e6;
+}
+
+// Predicts the delta at a module time from the fitted line.
+uint32_t CubeSatClockSync::predictDelta(uint32_t moduleTime)
+{
+    int32_t elapsed = static_cast<int32_t>(moduleTime - anchorTime);
+    return anchorDelta + static_cast<int32_t>(std::lround(skew * elapsed));
+}
+
+// Fits the skew and anchor to the recent window minimums.
+void CubeSatClockSync::fitMinimums()
+{
+    // Work relative to the newest minimum so wrapped times and deltas
+    // become small signed offsets.
+    uint32_t newestTime = minimumTimes[minimumCount - 1];
+    uint32_t newestDelta = minimumDeltas[minimumCount - 1];
+    double offsets[FIT_WINDOWS];
+    double deltas[FIT_WINDOWS];
+    for (int i = 0; i < minimumCount; i++)
+    {
+        offsets[i] = static_cast<int32_t>(minimumTimes[i] - newestTime);
+        deltas[i] = static_cast<int32_t>(minimumDeltas[i] - newestDelta);
+    }
+
+    // Fit the slope between the lowest minimum of the older half and the
+    // lowest of the newer half. Queueing delay only raises deltas, so
+    // the lowest points, measured against the current slope, are the
+    // least disturbed. Refining once more corrects for a poor slope.
+    int split = minimumCount / 2;
+    for (int pass = 0; pass < 2 && split > 0; pass++)
+    {
+        int older = 0;
+        int newer = minimumCount - 1;
+        for (int i = 0; i < minimumCount; i++)
+        {
+            int& lowest = i < split ? older : newer;
+            if (deltas[i] - skew * offsets[i] < deltas[lowest] - skew * offsets[lowest])
+            {
+                lowest = i;
+            }
+        }
+        if (offsets[newer] > offsets[older])
+        {
+            skew = (deltas[newer] - deltas[older]) / (offsets[newer] - offsets[older]);
+        }
+    }
+
+    // Lower the line through the newest minimum onto the lowest one.
+    double lowest = 0.0;
+    for (int i = 0; i < minimumCount; i++)
+    {
+        lowest = std::min(lowest, deltas[i] - skew * offsets[i]);
+    }
+
+    hasAnchor = true;
+    anchorTime = newestTime;
+    anchorDelta = newestDelta + static_cast<int32_t>(std::lround(lowest));
+}
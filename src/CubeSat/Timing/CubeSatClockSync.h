@@ -0,0 +1,96 @@
+// CubeSatClockSync.h
+
+/******************************************************************************
+    CubeSatClockSync Class Header
+
+    Purpose:
+        Estimates the mapping from a module's clock to the hub's clock using
+        one-way observations: the module's encode time carried in each frame
+        and the hub's ingest time for that frame.
+
+        Every observed delta (hub time - module time) is the clock offset
+        plus the transit delay, and queueing only ever adds delay. The
+        estimator therefore tracks the lower envelope of the deltas: it
+        keeps the least delayed delta in each window of observations and
+        fits the clock skew between the lowest of the older and newer
+        halves of the last FIT_WINDOWS window minimums, then lowers the
+        fitted line until no minimum lies below it. A single window
+        minimum still carries some queueing delay, so fitting over a
+        longer baseline keeps that noise out of the skew. The fitted
+        windows must span less than about 35 minutes of module time.
+
+        One-way observations cannot separate a constant transit delay from
+        the clock offset, so converted times are late by the minimum
+        transit delay. Latencies measured against them are the delay in
+        excess of that minimum.
+    Attributes:
+        windowCount:    integer  - Observations in the current window.
+        windowDelta:    uint32_t - Smallest delta in the current window.
+        windowTime:     uint32_t - Module time of windowDelta.
+        minimumTimes:   uint32_t[] - Module times of recent window
+                                     minimums, oldest first.
+        minimumDeltas:  uint32_t[] - Recent window minimum deltas.
+        minimumCount:   integer  - Number of recent window minimums.
+        hasAnchor:      bool     - Whether a window has completed.
+        anchorDelta:    uint32_t - Fitted delta at anchorTime.
+        anchorTime:     uint32_t - Module time of the last window minimum.
+        skew:           double   - Estimated drift of the delta in
+                                   microseconds per module microsecond.
+    Methods:
+        observe:
+            Adds a module/hub timestamp pair for the same event.
+        toHubTime:
+            Converts a module time to an estimated hub time.
+        isSynchronized:
+            Returns whether any observation has been made.
+        getSkew:
+            Returns the estimated skew in parts per million.
+******************************************************************************/
+
+#ifndef CUBESAT_CLOCK_SYNC_H
+#define CUBESAT_CLOCK_SYNC_H
+
+#include <cstdint>
+
+class CubeSatClockSync
+{
+    public:
+        static constexpr int WINDOW_SIZE = 16;
+
+        // Window minimums the skew is fitted to.
+        static constexpr int FIT_WINDOWS = 16;
+
+        // Adds a module/hub timestamp pair for the same event.
+        void observe(uint32_t moduleTime, uint32_t hubTime);
+
+        // Converts a module time to an estimated hub time.
+        uint32_t toHubTime(uint32_t moduleTime);
+
+        // Returns whether any observation has been made.
+        bool isSynchronized();
+
+        // Returns the estimated skew in parts per million.
+        double getSkew();
+
+    private:
+        // Predicts the delta at a module time from the fitted line.
+        uint32_t predictDelta(uint32_t moduleTime);
+
+        // Fits the skew and anchor to the recent window minimums.
+        void fitMinimums();
+
+        int windowCount = 0;
+        uint32_t windowDelta = 0;
+        uint32_t windowTime = 0;
+
+        uint32_t minimumTimes[FIT_WINDOWS];
+        uint32_t minimumDeltas[FIT_WINDOWS];
+        int minimumCount = 0;
+
+        bool hasAnchor = false;
+        uint32_t anchorDelta = 0;
+        uint32_t anchorTime = 0;
+        double skew = 0.0;
+};
+
+#endif
@@ -0,0 +1,126 @@
+// CubeSatFrameTrace.cpp
+
+/******************************************************************************
+    CubeSatFrameTrace Struct Implementation
+
+    Purpose:
+        Latency timestamps carried at the end of a module data stream.
+    Methods:
+        encode:
+            Encodes the trace, including its leading discriminator.
+        parse:
+            Reads the trace from the end of a module data stream.
+        find:
+            Returns the position of the trace within a data stream.
+    Helper Functions:
+        parseTraceValues:
+            Parses a comma-separated list of unsigned values.
+******************************************************************************/
+
+#include "CubeSatFrameTrace.h"
+#include "../CubeSatDataDiscriminators.h"
+
+// Prototypes
+bool parseTraceValues(const std::string& text, std::vector<uint32_t>& values);
+
+// Encodes the trace, including its leading discriminator.
+std::string CubeSatFrameTrace::encode() const
+{
+    std::string encoded = CubeSatDataDiscriminators::TRACE_DISCRIMINATOR + std::to_string(encodeTime);
+    for (uint32_t captureAge : captureAges)
+    {
+        encoded += CubeSatDataDiscriminators::DATUM_DISCRIMINATOR + std::to_string(captureAge);
+    }
+
+    if (hasHubStages)
+    {
+        encoded += CubeSatDataDiscriminators::HUB_TRACE_DISCRIMINATOR + std::to_string(ingestDelay)
+            + CubeSatDataDiscriminators::DATUM_DISCRIMINATOR + std::to_string(transmitDelay);
+    }
+    return encoded;
+}
+
+// Reads the trace from the end of a module data stream.
+bool CubeSatFrameTrace::parse(const std::string& dataStream, CubeSatFrameTrace& trace)
+{
+    size_t start = find(dataStream);
+    if (start == std::string::npos)
+    {
+        return false;
+    }
+
+    size_t end = dataStream.size();
+    if (end > start && dataStream[end - 1] == CubeSatDataDiscriminators::MODULE_DISCRIMINATOR)
+    {
+        end--;
+    }
+    std::string text = dataStream.substr(start + 1, end - start - 1);
+
+    // Split off the hub stages, if present.
+    std::string hubText = "";
+    size_t hubStart = text.find(CubeSatDataDiscriminators::HUB_TRACE_DISCRIMINATOR);
+    if (hubStart != std::string::npos)
+    {
+        hubText = text.substr(hubStart + 1);
+        text.erase(hubStart);
+    }
+
+    std::vector<uint32_t> values;
+    if (!parseTraceValues(text, values) || values.empty())
+    {
+        return false;
+    }
+    trace.encodeTime = values[0];
+    trace.captureAges.assign(values.begin() + 1, values.end());
+
+    trace.hasHubStages = hubStart != std::string::npos;
+    if (trace.hasHubStages)
+    {
+        if (!parseTraceValues(hubText, values) || values.size() != 2)
+        {
+            return false;
+        }
+        trace.ingestDelay = values[0];
+        trace.transmitDelay = values[1];
+    }
+    return true;
+}
+
+// Returns the position of the trace discriminator within a data stream.
+size_t CubeSatFrameTrace::find(const std::string& dataStream)
+{
+    return dataStream.rfind(CubeSatDataDiscriminators::TRACE_DISCRIMINATOR);
+}
+
+// Parses a comma-separated list of unsigned values.
+bool parseTraceValues(const std::string& text, std::vector<uint32_t>& values)
+{
+    values.clear();
+    uint32_t value = 0;
+    bool hasDigits = false;
+    for (char c : text)
+    {
+        if (c >= '0' && c <= '9')
+        {
+            value = value * 10 + (c - '0');
+            hasDigits = true;
+        }
+        else if (c == CubeSatDataDiscriminators::DATUM_DISCRIMINATOR && hasDigits)
+        {
+            values.push_back(value);
+            value = 0;
+            hasDigits = false;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    if (!hasDigits)
+    {
+        return text.empty();
+    }
+    values.push_back(value);
+    return true;
+}
@@ -0,0 +1,59 @@
+// CubeSatFrameTrace.h
+
+/******************************************************************************
+    CubeSatFrameTrace Struct Header
+
+    Purpose:
+        Latency timestamps carried at the end of a module data stream,
+        just before the module discriminator:
+            @<encode time>,<capture age>,...[/<ingest delay>,<transmit delay>]
+        The encode time is the module's clock when the frame was encoded.
+        Each capture age is how long before encoding a device's reading
+        was captured, in device order. The hub appends the ingest delay
+        (encode to hub ingest, in hub time) and the transmit delay (hub
+        ingest to downlink transmit) when it sends the frame down. All
+        values are microseconds.
+    Attributes:
+        encodeTime:     uint32_t         - Module time of frame encode.
+        captureAges:    vector<uint32_t> - Age of each device's reading at
+                                           encode.
+        hasHubStages:   bool             - Whether the hub stages are set.
+        ingestDelay:    uint32_t         - Encode to hub ingest.
+        transmitDelay:  uint32_t         - Hub ingest to downlink transmit.
+    Methods:
+        encode:
+            Encodes the trace, including its leading discriminator.
+        parse:
+            Reads the trace from the end of a module data stream.
+        find:
+            Returns the position of the trace within a data stream.
+******************************************************************************/
+
+#ifndef CUBESAT_FRAME_TRACE_H
+#define CUBESAT_FRAME_TRACE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct CubeSatFrameTrace
+{
+    uint32_t encodeTime = 0;
+    std::vector<uint32_t> captureAges;
+    bool hasHubStages = false;
+    uint32_t ingestDelay = 0;
+    uint32_t transmitDelay = 0;
+
+    // Encodes the trace, including its leading discriminator.
+    std::string encode() const;
+
+    // Reads the trace from the end of a module data stream. Returns false
+    // if the data stream has no well-formed trace.
+    static bool parse(const std::string& dataStream, CubeSatFrameTrace& trace);
+
+    // Returns the position of the trace discriminator within a data
+    // stream, or std::string::npos if it has no trace.
+    static size_t find(const std::string& dataStream);
+};
+
+#endif
@@ -0,0 +1,69 @@
+// CubeSatLatencyStats.cpp
+
+/******************************************************************************
+    CubeSatLatencyStats Class Implementation
+
+    Purpose:
+        Keeps a rolling window of latency samples for one pipeline stage
+        and reports percentiles over the window.
+    Methods:
+        record:
+            Adds a latency sample, replacing the oldest once full.
+        percentile:
+            Returns the given percentile of the window.
+        getCount:
+            Returns the number of samples in the window.
+        formatSummary:
+            Encodes the window's count and percentiles as a comma-separated
+            string.
+******************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include "CubeSatLatencyStats.h"
+
+// Adds a latency sample, replacing the oldest once full.
+void CubeSatLatencyStats::record(uint32_t latency)
+{
+    samples[next] = latency;
+    next = (next + 1) % WINDOW_SIZE;
+    if (count < WINDOW_SIZE)
+    {
+        count++;
+    }
+}
+
+// Returns the given percentile of the window.
+uint32_t CubeSatLatencyStats::percentile(double percent)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // Select on a copy so the ring buffer keeps its order.
+    uint32_t sorted[WINDOW_SIZE];
+    std::copy(samples, samples + count, sorted);
+
+    double clamped = std::min(std::max(percent, 0.0), 100.0);
+    size_t rank = static_cast<size_t>(std::ceil(clamped / 100.0 * count));
+    size_t index = rank == 0 ? 0 : rank - 1;
+    std::nth_element(sorted, sorted + index, sorted + count);
+    return sorted[index];
+}
+
+// Returns the number of samples in the window.
+size_t CubeSatLatencyStats::getCount()
+{
+    return count;
+}
+
+// Encodes the window's count and percentiles as a comma-separated string.
+std::string CubeSatLatencyStats::formatSummary()
+{
+    return std::to_string(count)
+        + "," + std::to_string(percentile(50))
+        + "," + std::to_string(percentile(90))
+        + "," + std::to_string(percentile(99))
+        + "," + std::to_string(percentile(100));
+}
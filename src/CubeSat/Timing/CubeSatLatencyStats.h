@@ -0,0 +1,56 @@
+// CubeSatLatencyStats.h
+
+/******************************************************************************
+    CubeSatLatencyStats Class Header
+
+    Purpose:
+        Keeps a rolling window of latency samples for one pipeline stage
+        and reports percentiles over the window.
+    Attributes:
+        samples:    uint32_t[] - Ring buffer of latencies in microseconds.
+        count:      integer    - Number of samples in the window.
+        next:       integer    - Index the next sample is written to.
+    Methods:
+        record:
+            Adds a latency sample, replacing the oldest once full.
+        percentile:
+            Returns the given percentile of the window.
+        getCount:
+            Returns the number of samples in the window.
+        formatSummary:
+            Encodes the window's count and percentiles as a comma-separated
+            string.
+******************************************************************************/
+
+#ifndef CUBESAT_LATENCY_STATS_H
+#define CUBESAT_LATENCY_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class CubeSatLatencyStats
+{
+    public:
+        static constexpr size_t WINDOW_SIZE = 128;
+
+        // Adds a latency sample, replacing the oldest once full.
+        void record(uint32_t latency);
+
+        // Returns the given percentile (0 to 100) of the window using the
+        // nearest-rank method, or 0 if the window is empty.
+        uint32_t percentile(double percent);
+
+        // Returns the number of samples in the window.
+        size_t getCount();
+
+        // Encodes the window as "<count>,<p50>,<p90>,<p99>,<max>".
+        std::string formatSummary();
+
+    private:
+        uint32_t samples[WINDOW_SIZE];
+        size_t count = 0;
+        size_t next = 0;
+};
+
+#endif
@@ -1,19 +1,168 @@
 #include <Arduino.h>
 #include "CubeSat/CubeSatInitializer.h"
 #include "CubeSat/CubeSatModule.h"
+#include "CubeSat/CubeSatHub.h"
+#include "CubeSat/Logging/CubeSatFlightLog.h"
+#include "CubeSat/Logging/CubeSatLogExporter.h"
+#include "CubeSat/Logging/CubeSatSdLogStorage.h"
+#include "CubeSat/Timing/CubeSatArduinoClock.h"
+#include "CubeSat/Power/CubeSatDutyCycle.h"
+#include "CubeSat/Power/CubeSatEsp32PowerControl.h"
+#include "CubeSat/Power/CubeSatSerialWake.h"
 
-CubeSatModule* module; 
+// Serial speed used for log export.
+const unsigned long SERIAL_BAUD_RATE = 921600;
+
+// Milliseconds between flight log flushes.
+const unsigned long LOG_FLUSH_INTERVAL_MS = 10000;
+
+// Milliseconds between statistics records in the flight log.
+const unsigned long STATS_INTERVAL_MS = 60000;
+
+// Serial command that sends the current statistics, framed like an export.
+const std::string STATS_COMMAND = "STATS";
+
+// Keyword starting every log export command.
+const std::string EXPORT_COMMAND = "EXPORT";
+
+// Milliseconds to stay out of light sleep after serial input or a serial
+// wakeup, so the rest of an export command is not lost. Input wakes the
+// module from light sleep, but the characters that wake it are dropped,
+// so the line they start is ignored without a reply unless it still
+// begins with a known command. Ground software should send a throwaway
+// wake line (e.g. an empty line) and wait briefly before a command if the
+// module may be asleep, and retry a command that gets no reply.
+const unsigned long SERIAL_AWAKE_MS = 5000;
+
+CubeSatModule* module;
+CubeSatArduinoClock systemClock;
+CubeSatEsp32PowerControl powerControl(&Serial);
+CubeSatDutyCycle dutyCycle(&systemClock, &powerControl);
+CubeSatSerialWake serialWake({ EXPORT_COMMAND, STATS_COMMAND }, SERIAL_AWAKE_MS);
+
+CubeSatSdLogStorage logStorage;
+CubeSatFlightLog flightLog(&logStorage, "/CubeSatLog.txt", "/CubeSatLog.idx");
+CubeSatStreamLogSink serialSink(&Serial);
+CubeSatLogExporter logExporter(&flightLog, &serialSink);
+
+std::string serialCommand = "";
+unsigned long lastLogFlush = 0;
+unsigned long lastStats = 0;
 
 // put function declarations here:
 int myFunction(int, int);
+void scheduleAt(unsigned long deadline);
+std::vector<std::string> collectStats();
+void handleSerialCommand(const std::string& command);
 
 void setup() {
+  Serial.begin(SERIAL_BAUD_RATE);
+
+  CubeSatInitializer initializer;
+  module = initializer.initializeCubeSat();
+  module->setClock(&systemClock);
+  flightLog.begin();
+  powerControl.begin();
 }
 
 void loop() {
+  unsigned long now = millis();
+
+  // Sample first, so a refresh includes the sample due at the same time.
+  module->sampleDevices(now);
+
+  if (module->refreshIfDue(now)) {
+    if (module->checkIsHub()) {
+      // The hub sends its own data down alongside the other modules'.
+      CubeSatHub* hub = static_cast<CubeSatHub*>(module);
+      hub->ingestDataStream(module->getDataStream());
+      for (const std::string& dataStream : hub->takeDownlinkDataStreams()) {
+        flightLog.append(now, dataStream);
+      }
+    } else {
+      flightLog.append(now, module->getDataStream());
+    }
+  }
+
+  // Keep a record of the statistics alongside the data they describe.
+  if (now - lastStats >= STATS_INTERVAL_MS) {
+    lastStats = now;
+    for (const std::string& stats : collectStats()) {
+      flightLog.append(now, stats);
+    }
+  }
+
+  if (now - lastLogFlush >= LOG_FLUSH_INTERVAL_MS) {
+    lastLogFlush = now;
+    flightLog.flush();
+  }
+
+  // Handle log export and statistics commands, one per line.
+  while (Serial.available()) {
+    serialWake.noteInput(now);
+    char c = Serial.read();
+    if (c == '\n') {
+      if (serialWake.acceptLine(serialCommand)) {
+        handleSerialCommand(serialCommand);
+      }
+      serialCommand.clear();
+    } else {
+      serialCommand += c;
+    }
+  }
+
+  // Sleep until the next sample, refresh (and transmit slot) or flush.
+  dutyCycle.beginCycle();
+  scheduleAt(module->getNextRefreshTime());
+  scheduleAt(lastLogFlush + LOG_FLUSH_INTERVAL_MS);
+  scheduleAt(lastStats + STATS_INTERVAL_MS);
+
+  unsigned long nextSampleTime;
+  if (module->getNextSampleTime(millis(), nextSampleTime)) {
+    scheduleAt(nextSampleTime);
+  }
+
+  dutyCycle.setSleepAllowed(serialWake.isSleepAllowed(millis()));
+  dutyCycle.waitForDeadline();
+
+  // Serial input woke the module, dropping the first characters of
+  // whatever line it started. Stay awake for the rest of it.
+  if (dutyCycle.getWokeEarly()) {
+    serialCommand.clear();
+    serialWake.noteWakeup(millis());
+  }
 }
 
 // put function definitions here:
 int myFunction(int x, int y) {
   return x + y;
-}
\ No newline at end of file
+}
+
+// Adds a millis() deadline to the duty cycle.
+void scheduleAt(unsigned long deadline) {
+  long remaining = static_cast<long>(deadline - millis());
+  dutyCycle.addDeadlineIn(remaining * 1000);
+}
+
+// Gathers the statistics lines kept in the flight log and sent by STATS.
+std::vector<std::string> collectStats() {
+  std::vector<std::string> stats = dutyCycle.getPowerReport();
+  if (module->checkIsHub()) {
+    for (const std::string& line : static_cast<CubeSatHub*>(module)->getLatencyReport()) {
+      stats.push_back(line);
+    }
+  }
+  return stats;
+}
+
+// Answers STATS with the current statistics and passes anything else
+// to the log exporter.
+void handleSerialCommand(const std::string& command) {
+  size_t end = command.find_last_not_of(" \t\r");
+  if (end == std::string::npos || command.substr(0, end + 1) != STATS_COMMAND) {
+    logExporter.handleCommand(command);
+    return;
+  }
+
+  logExporter.sendLines(collectStats());
+}
@@ -0,0 +1,406 @@
+// test_duty_cycle.cpp
+
+/******************************************************************************
+    Duty Cycle Tests
+
+    Purpose:
+        Exercises the duty-cycle scheduler against a simulated clock and
+        power controls: power state thresholds, wakeup margin adaptation,
+        overshoot for 50 ms and 1 s deadlines, early wakeups, the power
+        report and handling of serial commands that wake the module.
+******************************************************************************/
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include <unity.h>
+#include "CubeSat/Power/CubeSatDutyCycle.h"
+#include "CubeSat/Power/CubeSatSerialWake.h"
+
+// Characters lost by a serial wakeup, including the line terminator.
+static constexpr size_t WAKEUP_DROPPED_CHARACTERS = 4;
+
+// Clock advanced by the simulated power controls, wrapping like micros().
+class SimulatedClock : public CubeSatClock
+{
+    public:
+        uint32_t micros() override { return static_cast<uint32_t>(now); }
+
+        uint64_t now = 0;
+};
+
+// Power controls that advance the simulated clock. Light sleep overruns
+// its timer by a wakeup latency drawn between minLatency and maxLatency,
+// or ends after earlyFraction of its duration if set, or ends when
+// serial input arrives at inputTime.
+class SimulatedPowerControl : public CubeSatPowerControl
+{
+    public:
+        // Time a CPU frequency switch takes, in microseconds.
+        static constexpr uint32_t FREQUENCY_SWITCH_TIME = 40;
+
+        SimulatedPowerControl(SimulatedClock* clock) : clock(clock) {}
+
+        void idle(uint32_t duration) override
+        {
+            idles++;
+            clock->now += duration;
+        }
+
+        void lightSleep(uint32_t duration) override
+        {
+            sleeps++;
+            if (earlyFraction > 0.0)
+            {
+                clock->now += static_cast<uint64_t>(duration * earlyFraction);
+                return;
+            }
+            std::uniform_int_distribution<uint32_t> latency(minLatency, maxLatency);
+            clock->now = std::min(clock->now + duration + latency(random), std::max(clock->now, inputTime));
+        }
+
+        void setCpuFrequency(uint32_t megahertz) override
+        {
+            if (megahertz != frequency)
+            {
+                frequency = megahertz;
+                frequencySwitches++;
+                clock->now += FREQUENCY_SWITCH_TIME;
+            }
+        }
+
+        uint32_t minLatency = 200;
+        uint32_t maxLatency = 1100;
+        double earlyFraction = 0.0;
+        uint64_t inputTime = UINT64_MAX;
+
+        uint32_t frequency = 240;
+        int idles = 0;
+        int sleeps = 0;
+        int frequencySwitches = 0;
+
+    private:
+        SimulatedClock* clock;
+        std::mt19937 random{ 2 };
+};
+
+SimulatedClock* simulatedClock;
+SimulatedPowerControl* power;
+CubeSatDutyCycleConfig config;
+
+void setUp()
+{
+    simulatedClock = new SimulatedClock();
+    power = new SimulatedPowerControl(simulatedClock);
+}
+
+void tearDown()
+{
+    delete power;
+    delete simulatedClock;
+}
+
+// A line of serial input and the time it arrives, in microseconds.
+struct SerialLine
+{
+    uint64_t time;
+    std::string text;
+};
+
+// The serial handling of the main loop, refreshing once a second.
+class SimulatedMainLoop
+{
+    public:
+        SimulatedMainLoop(std::vector<SerialLine> lines)
+            : dutyCycle(simulatedClock, power, config), serialWake({ "EXPORT", "STATS" }), lines(lines) {}
+
+        // Runs the loop until the simulated clock reaches until.
+        void run(uint64_t until)
+        {
+            while (simulatedClock->now < until)
+            {
+                unsigned long now = millis();
+                while (nextLine < lines.size() && lines[nextLine].time <= simulatedClock->now)
+                {
+                    serialWake.noteInput(now);
+                    if (serialWake.acceptLine(lines[nextLine].text))
+                    {
+                        handledLines.push_back(lines[nextLine].text);
+                    }
+                    nextLine++;
+                }
+                if (simulatedClock->now >= nextRefresh)
+                {
+                    nextRefresh += 1000000;
+                }
+
+                power->inputTime = nextLine < lines.size() ? lines[nextLine].time : UINT64_MAX;
+                dutyCycle.beginCycle();
+                dutyCycle.addDeadline(static_cast<uint32_t>(nextRefresh));
+                dutyCycle.setSleepAllowed(serialWake.isSleepAllowed(millis()));
+                dutyCycle.waitForDeadline();
+
+                if (dutyCycle.getWokeEarly())
+                {
+                    // The characters that woke the module are lost.
+                    std::string& text = lines[nextLine].text;
+                    if (text.size() < WAKEUP_DROPPED_CHARACTERS)
+                    {
+                        nextLine++;
+                    }
+                    else
+                    {
+                        text.erase(0, WAKEUP_DROPPED_CHARACTERS);
+                    }
+                    serialWake.noteWakeup(millis());
+                }
+            }
+        }
+
+        CubeSatDutyCycle dutyCycle;
+        CubeSatSerialWake serialWake;
+        std::vector<std::string> handledLines;
+
+    private:
+        static unsigned long millis() { return static_cast<unsigned long>(simulatedClock->now / 1000); }
+
+        std::vector<SerialLine> lines;
+        size_t nextLine = 0;
+        uint64_t nextRefresh = 1000000;
+};
+
+// Waits for a deadline gap microseconds away and returns the state used.
+CubeSatDutyCycle::PowerState waitFor(CubeSatDutyCycle& dutyCycle, uint32_t gap, bool sleepAllowed = true)
+{
+    dutyCycle.beginCycle();
+    dutyCycle.addDeadlineIn(gap);
+    dutyCycle.setSleepAllowed(sleepAllowed);
+    return dutyCycle.waitForDeadline();
+}
+
+// Runs a main loop servicing a periodic deadline and returns the worst
+// overshoot past it, in microseconds.
+uint32_t runPeriodicDeadline(CubeSatDutyCycle& dutyCycle, uint32_t period, int cycles)
+{
+    uint32_t deadline = simulatedClock->micros() + period;
+    uint32_t worstOvershoot = 0;
+    for (int cycle = 0; cycle < cycles; cycle++)
+    {
+        dutyCycle.beginCycle();
+        dutyCycle.addDeadline(deadline);
+        dutyCycle.waitForDeadline();
+
+        uint32_t overshoot = simulatedClock->micros() - deadline;
+        worstOvershoot = std::max(worstOvershoot, overshoot);
+
+        // Service the deadline.
+        simulatedClock->now += 300;
+        deadline += period;
+    }
+    return worstOvershoot;
+}
+
+void test_state_matches_thresholds()
+{
+    CubeSatDutyCycle dutyCycle(simulatedClock, power, config);
+    TEST_ASSERT_EQUAL(CubeSatDutyCycle::ACTIVE, dutyCycle.chooseState(0));
+    TEST_ASSERT_EQUAL(CubeSatDutyCycle::IDLE, dutyCycle.chooseState(1));
+    TEST_ASSERT_EQUAL(CubeSatDutyCycle::IDLE, dutyCycle.chooseState(config.lowFrequencyThreshold - 1));
+    TEST_ASSERT_EQUAL(CubeSatDutyCycle::LOW_FREQUENCY_IDLE, dutyCycle.chooseState(config.lowFrequencyThreshold));
+    TEST_ASSERT_EQUAL(CubeSatDutyCycle::LOW_FREQUENCY_IDLE, dutyCycle.chooseState(config.lightSleepThreshold - 1));
+    TEST_ASSERT_EQUAL(CubeSatDutyCycle::LIGHT_SLEEP, dutyCycle.chooseState(config.lightSleepThreshold));
+
+    // Light sleep is never used when disallowed.
+    dutyCycle.setSleepAllowed(false);
+    TEST_ASSERT_EQUAL(CubeSatDutyCycle::LOW_FREQUENCY_IDLE, dutyCycle.chooseState(config.maxWait));
+}
+
+void test_wait_uses_chosen_state()
+{
+    CubeSatDutyCycle dutyCycle(simulatedClock, power, config);
+
+    TEST_ASSERT_EQUAL(CubeSatDutyCycle::IDLE, waitFor(dutyCycle, 1000));
+    TEST_ASSERT_EQUAL(1, power->idles);
+    TEST_ASSERT_EQUAL(0, power->frequencySwitches);
+
+    // Low clock idling switches down and back up again.
+    TEST_ASSERT_EQUAL(CubeSatDutyCycle::LOW_FREQUENCY_IDLE, waitFor(dutyCycle, 5000));
+    TEST_ASSERT_EQUAL(2, power->frequencySwitches);
+    TEST_ASSERT_EQUAL(config.activeFrequency, power->frequency);
+
+    TEST_ASSERT_EQUAL(CubeSatDutyCycle::LIGHT_SLEEP, waitFor(dutyCycle, 50000));
+    TEST_ASSERT_EQUAL(1, power->sleeps);
+    TEST_ASSERT_EQUAL(CubeSatDutyCycle::LOW_FREQUENCY_IDLE, waitFor(dutyCycle, 50000, false));
+    TEST_ASSERT_EQUAL(1, power->sleeps);
+
+    // An overdue deadline is serviced straight away.
+    dutyCycle.beginCycle();
+    dutyCycle.addDeadlineIn(-5000);
+    TEST_ASSERT_EQUAL(CubeSatDutyCycle::ACTIVE, dutyCycle.waitForDeadline());
+}
+
+void test_wakeup_margin_adapts()
+{
+    CubeSatDutyCycle dutyCycle(simulatedClock, power, config);
+    TEST_ASSERT_EQUAL_UINT32(config.minWakeupMargin, dutyCycle.getWakeupMargin());
+
+    // A late wakeup raises the margin to cover it straight away.
+    power->minLatency = 800;
+    power->maxLatency = 800;
+    waitFor(dutyCycle, 50000);
+    TEST_ASSERT_EQUAL_UINT32(config.minWakeupMargin + 800, dutyCycle.getWakeupMargin());
+
+    // With the margin covering the latency, wakeups land on time.
+    waitFor(dutyCycle, 50000);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(config.lateTolerance, dutyCycle.getOvershoot()->percentile(100));
+
+    // Faster wakeups let the margin decay slowly back towards the minimum.
+    power->minLatency = 100;
+    power->maxLatency = 100;
+    waitFor(dutyCycle, 50000);
+    uint32_t margin = dutyCycle.getWakeupMargin();
+    TEST_ASSERT_LESS_THAN_UINT32(config.minWakeupMargin + 800, margin);
+    TEST_ASSERT_GREATER_THAN_UINT32(config.minWakeupMargin + 600, margin);
+    for (int i = 0; i < 100; i++)
+    {
+        waitFor(dutyCycle, 50000);
+    }
+    TEST_ASSERT_UINT32_WITHIN(10, config.minWakeupMargin + 100, dutyCycle.getWakeupMargin());
+}
+
+// Checks overshoot past a periodic deadline stays under the late
+// tolerance, with the module spending most of its time asleep.
+void checkPeriodicOvershoot(uint32_t period, int cycles)
+{
+    CubeSatDutyCycle dutyCycle(simulatedClock, power, config);
+    uint32_t worstOvershoot = runPeriodicDeadline(dutyCycle, period, cycles);
+
+    std::string message = std::to_string(period) + " us deadlines: worst overshoot "
+        + std::to_string(worstOvershoot) + " us, p99 "
+        + std::to_string(dutyCycle.getOvershoot()->percentile(99)) + " us, margin "
+        + std::to_string(dutyCycle.getWakeupMargin()) + " us";
+    TEST_MESSAGE(message.c_str());
+
+    TEST_ASSERT_LESS_THAN_UINT32(config.lateTolerance, worstOvershoot);
+    TEST_ASSERT_EQUAL_UINT32(0, dutyCycle.getLateWakeups());
+    TEST_ASSERT_EQUAL(cycles, power->sleeps);
+
+    uint64_t sleepTime = dutyCycle.getTimeInState(CubeSatDutyCycle::LIGHT_SLEEP);
+    TEST_ASSERT_GREATER_THAN_DOUBLE(0.9, static_cast<double>(sleepTime) / simulatedClock->now);
+}
+
+void test_overshoot_within_tolerance_50_ms()
+{
+    checkPeriodicOvershoot(50000, 2000);
+}
+
+void test_overshoot_within_tolerance_1_s()
+{
+    checkPeriodicOvershoot(1000000, 200);
+}
+
+void test_overshoot_across_clock_wrap()
+{
+    // Start just before micros() wraps.
+    simulatedClock->now = UINT32_MAX - 2000000;
+    CubeSatDutyCycle dutyCycle(simulatedClock, power, config);
+    waitFor(dutyCycle, 0);
+    TEST_ASSERT_LESS_THAN_UINT32(config.lateTolerance, runPeriodicDeadline(dutyCycle, 50000, 200));
+    TEST_ASSERT_EQUAL_UINT32(0, dutyCycle.getLateWakeups());
+}
+
+void test_early_wakeup_is_not_overshoot()
+{
+    CubeSatDutyCycle dutyCycle(simulatedClock, power, config);
+    power->earlyFraction = 0.1;
+    uint32_t start = simulatedClock->micros();
+
+    TEST_ASSERT_EQUAL(CubeSatDutyCycle::LIGHT_SLEEP, waitFor(dutyCycle, 500000));
+    TEST_ASSERT_TRUE(dutyCycle.getWokeEarly());
+    TEST_ASSERT_EQUAL_UINT32(1, dutyCycle.getEarlyWakeups());
+    TEST_ASSERT_LESS_THAN_UINT32(100000, simulatedClock->micros() - start);
+    TEST_ASSERT_EQUAL(0, dutyCycle.getOvershoot()->getCount());
+    TEST_ASSERT_EQUAL_UINT32(config.minWakeupMargin, dutyCycle.getWakeupMargin());
+
+    power->earlyFraction = 0.0;
+    waitFor(dutyCycle, 500000);
+    TEST_ASSERT_FALSE(dutyCycle.getWokeEarly());
+}
+
+void test_power_report()
+{
+    CubeSatDutyCycle dutyCycle(simulatedClock, power, config);
+    simulatedClock->now += 1000;
+    waitFor(dutyCycle, 1000);
+    waitFor(dutyCycle, 5000);
+    waitFor(dutyCycle, 50000);
+
+    std::vector<std::string> report = dutyCycle.getPowerReport();
+    TEST_ASSERT_EQUAL(2, report.size());
+
+    // State times account for every microsecond since boot.
+    std::string power = "POWER";
+    uint64_t total = 0;
+    for (int state = 0; state < CubeSatDutyCycle::POWER_STATE_COUNT; state++)
+    {
+        uint64_t time = dutyCycle.getTimeInState(static_cast<CubeSatDutyCycle::PowerState>(state));
+        power += "," + std::to_string(time);
+        total += time;
+    }
+    TEST_ASSERT_EQUAL_STRING(power.c_str(), report[0].c_str());
+    TEST_ASSERT_EQUAL_UINT64(simulatedClock->now, total);
+
+    std::string wakeup = "WAKEUP,0,0," + std::to_string(dutyCycle.getWakeupMargin())
+        + "," + dutyCycle.getOvershoot()->formatSummary();
+    TEST_ASSERT_EQUAL_STRING(wakeup.c_str(), report[1].c_str());
+}
+
+void test_wake_line_keeps_module_awake()
+{
+    // Ground sends an empty wake line, then a command shortly after.
+    SimulatedMainLoop mainLoop({ { 10500000, "" }, { 10700000, "EXPORT ALL" } });
+    mainLoop.run(10500000);
+    int sleeps = power->sleeps;
+
+    // The wake line is lost entirely, but the module stays awake for
+    // the command and does not sleep again until the hold-off ends.
+    mainLoop.run(10500000 + CubeSatSerialWake::DEFAULT_AWAKE_INTERVAL_MS * 1000 - 100000);
+    TEST_ASSERT_EQUAL_UINT32(1, mainLoop.dutyCycle.getEarlyWakeups());
+    TEST_ASSERT_EQUAL(sleeps, power->sleeps);
+    TEST_ASSERT_EQUAL(1, mainLoop.handledLines.size());
+    TEST_ASSERT_EQUAL_STRING("EXPORT ALL", mainLoop.handledLines[0].c_str());
+
+    mainLoop.run(20000000);
+    TEST_ASSERT_GREATER_THAN(sleeps, power->sleeps);
+}
+
+void test_line_after_wakeup_is_ignored_unless_a_command()
+{
+    // A command that wakes the module arrives garbled and is ignored. A
+    // retry and a command whose loss falls in leading whitespace are
+    // handled, and blank lines never are.
+    SimulatedMainLoop mainLoop({ { 10500000, "EXPORT ALL" }, { 11500000, "EXPORT ALL" },
+        { 12000000, " " }, { 20500000, "    STATS" } });
+    mainLoop.run(25000000);
+    TEST_ASSERT_EQUAL_UINT32(2, mainLoop.dutyCycle.getEarlyWakeups());
+    TEST_ASSERT_EQUAL(2, mainLoop.handledLines.size());
+    TEST_ASSERT_EQUAL_STRING("EXPORT ALL", mainLoop.handledLines[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("STATS", mainLoop.handledLines[1].c_str());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_state_matches_thresholds);
+    RUN_TEST(test_wait_uses_chosen_state);
+    RUN_TEST(test_wakeup_margin_adapts);
+    RUN_TEST(test_overshoot_within_tolerance_50_ms);
+    RUN_TEST(test_overshoot_within_tolerance_1_s);
+    RUN_TEST(test_overshoot_across_clock_wrap);
+    RUN_TEST(test_early_wakeup_is_not_overshoot);
+    RUN_TEST(test_power_report);
+    RUN_TEST(test_wake_line_keeps_module_awake);
+    RUN_TEST(test_line_after_wakeup_is_ignored_unless_a_command);
+    return UNITY_END();
+}
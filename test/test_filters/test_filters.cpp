@@ -0,0 +1,299 @@
+// test_filters.cpp
+
+/******************************************************************************
+    Filter Tests
+
+    Purpose:
+        Exercises the fixed-point decimating filters and the filter stage:
+        DC gain, stopband attenuation, CIC integrator wraparound, sample
+        saturation, one output per module refresh under jittered wakeups
+        and the per-sample cost of process().
+******************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include <unity.h>
+#include "CubeSat/Filters/CubeSatCicFilter.h"
+#include "CubeSat/Filters/CubeSatFirFilter.h"
+#include "CubeSat/Filters/CubeSatFilterStage.h"
+#include "CubeSat/CubeSatModule.h"
+
+static const double PI = 3.14159265358979323846;
+
+// Amplitude of test tones in fixed-point counts.
+static constexpr double TONE_AMPLITUDE = 1000000.0;
+
+// Device whose single field counts the samples taken from it.
+class CountingDevice : public CubeSatDevice
+{
+    public:
+        CountingDevice() : CubeSatDevice(0, "COUNTER") {}
+
+        void initializeDevice(void*) override {}
+
+        std::string readSensor() override { return ""; }
+
+        size_t sampleFields(double* fields) override
+        {
+            fields[0] = sampleCount++;
+            return 1;
+        }
+
+        unsigned long sampleCount = 0;
+};
+
+void setUp() {}
+
+void tearDown() {}
+
+// Runs input through a filter a block at a time, as the filter stage does.
+std::vector<int32_t> runFilter(CubeSatFilter& filter, const std::vector<int32_t>& input)
+{
+    std::vector<int32_t> output(input.size() + 1);
+    size_t outputCount = 0;
+    for (size_t i = 0; i < input.size(); i += CubeSatFilterStage::BLOCK_SIZE)
+    {
+        size_t count = input.size() - i;
+        if (count > CubeSatFilterStage::BLOCK_SIZE)
+        {
+            count = CubeSatFilterStage::BLOCK_SIZE;
+        }
+        outputCount += filter.process(&input[i], count, &output[outputCount]);
+    }
+    output.resize(outputCount);
+    return output;
+}
+
+// Returns the steady-state gain of a filter at a frequency given as a
+// fraction of the input sample rate.
+double measureGain(CubeSatFilter& filter, double frequency)
+{
+    filter.reset();
+    std::vector<int32_t> input(8192);
+    for (size_t i = 0; i < input.size(); i++)
+    {
+        input[i] = static_cast<int32_t>(std::lround(TONE_AMPLITUDE * std::sin(2 * PI * frequency * i)));
+    }
+
+    // Skip the start-up transient.
+    std::vector<int32_t> output = runFilter(filter, input);
+    double peak = 0;
+    for (size_t i = output.size() / 4; i < output.size(); i++)
+    {
+        peak = std::max(peak, std::fabs(static_cast<double>(output[i])));
+    }
+    return peak / TONE_AMPLITUDE;
+}
+
+// Returns the worst gain of a filter from a frequency up to Nyquist, in dB.
+double measureStopband(CubeSatFilter& filter, double stopbandStart)
+{
+    double worstGain = 0;
+    for (double frequency = stopbandStart; frequency <= 0.5; frequency += 0.0037)
+    {
+        worstGain = std::max(worstGain, measureGain(filter, frequency));
+    }
+    return 20 * std::log10(worstGain);
+}
+
+// Checks a constant input comes out unchanged once the filter settles.
+void checkDcGain(CubeSatFilter& filter, int32_t level)
+{
+    filter.reset();
+    std::vector<int32_t> input(256, level);
+    std::vector<int32_t> output = runFilter(filter, input);
+    TEST_ASSERT_GREATER_THAN(0, output.size());
+    TEST_ASSERT_EQUAL_INT32(level, output.back());
+}
+
+void test_cic_dc_gain_is_unity()
+{
+    for (int order = 1; order <= 4; order++)
+    {
+        for (int decimation : { 2, 8, 16 })
+        {
+            CubeSatCicFilter filter(decimation, order);
+            checkDcGain(filter, 1013250);
+            checkDcGain(filter, -40125);
+        }
+    }
+}
+
+void test_fir_dc_gain_is_unity()
+{
+    for (int taps : { 7, 15, 31 })
+    {
+        CubeSatFirFilter filter(4, taps, 0.1);
+
+        // Taps are quantized to Q15, so allow a count of rounding.
+        filter.reset();
+        std::vector<int32_t> output = runFilter(filter, std::vector<int32_t>(256, 1013250));
+        TEST_ASSERT_GREATER_THAN(0, output.size());
+        TEST_ASSERT_INT32_WITHIN(1, 1013250, output.back());
+    }
+}
+
+void test_cic_stopband_attenuation()
+{
+    // Third order CIC decimating by 8 to 1/16 of the input rate.
+    CubeSatCicFilter filter(8, 3);
+    TEST_ASSERT_DOUBLE_WITHIN(0.01, 1.0, measureGain(filter, 0.0001));
+    double stopband = measureStopband(filter, 0.15);
+    TEST_MESSAGE(("CIC(8, 3) stopband " + std::to_string(stopband) + " dB").c_str());
+    TEST_ASSERT_LESS_THAN_DOUBLE(-35.0, stopband);
+}
+
+void test_fir_stopband_attenuation()
+{
+    CubeSatFirFilter filter(4, 15, 0.1);
+    TEST_ASSERT_DOUBLE_WITHIN(0.01, 1.0, measureGain(filter, 0.0001));
+    TEST_ASSERT_DOUBLE_WITHIN(0.05, 0.5, measureGain(filter, 0.1));
+    double stopband = measureStopband(filter, 0.2);
+    TEST_MESSAGE(("FIR(4, 15, 0.1) stopband " + std::to_string(stopband) + " dB").c_str());
+    TEST_ASSERT_LESS_THAN_DOUBLE(-30.0, stopband);
+}
+
+void test_cic_integrators_wrap()
+{
+    // A full-scale input drives the last of four integrators past 2^64
+    // within a few thousand samples. The combs undo the wrap.
+    CubeSatCicFilter filter(8, 4);
+    std::vector<int32_t> input(40000, INT32_MAX);
+    std::vector<int32_t> output = runFilter(filter, input);
+    TEST_ASSERT_EQUAL(input.size() / 8 - 3, output.size());
+    for (int32_t value : output)
+    {
+        TEST_ASSERT_EQUAL_INT32(INT32_MAX, value);
+    }
+
+    // And keeps tracking after a step between the extremes.
+    std::fill(input.begin(), input.end(), INT32_MIN);
+    output = runFilter(filter, input);
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, output.back());
+}
+
+void test_stage_saturates_large_readings()
+{
+    CubeSatFilterStage stage;
+    stage.setFilter(0, new CubeSatCicFilter(4, 2));
+    stage.setFilter(1, new CubeSatCicFilter(4, 2));
+    for (int i = 0; i < 64; i++)
+    {
+        double fields[3] = { 5.0e6, -5.0e6, 5.0e6 };
+        stage.addSample(fields, 3);
+    }
+
+    double outputs[CubeSatFilterStage::MAX_FIELDS];
+    TEST_ASSERT_EQUAL(3, stage.readOutputs(outputs));
+    TEST_ASSERT_DOUBLE_WITHIN(0.001, INT32_MAX / CubeSatFilterStage::FIXED_POINT_SCALE, outputs[0]);
+    TEST_ASSERT_DOUBLE_WITHIN(0.001, INT32_MIN / CubeSatFilterStage::FIXED_POINT_SCALE, outputs[1]);
+
+    // Unfiltered fields pass straight through.
+    TEST_ASSERT_DOUBLE_WITHIN(0.001, 5.0e6, outputs[2]);
+}
+
+// Reads the single field of a one-device module data stream.
+double readField(const std::string& dataStream)
+{
+    return std::stod(dataStream.substr(dataStream.find(':') + 1));
+}
+
+void test_one_output_per_refresh()
+{
+    // A boxcar over 10 samples taken every 100 ms, refreshed every 1 s.
+    // Each output of the counting device is 10 more than the last.
+    CountingDevice* device = new CountingDevice();
+    CubeSatFilterStage* stage = new CubeSatFilterStage();
+    stage->setFilter(0, new CubeSatCicFilter(10, 1));
+    device->setFilterStage(stage);
+    device->setSampleInterval(100);
+    CubeSatModule module(false, 7, { device });
+    module.setRefreshInterval(1000);
+
+    // Run the main loop, waking up to 3 ms late and sometimes much later
+    // while blocked on an export.
+    std::mt19937 random(3);
+    std::uniform_int_distribution<unsigned long> jitter(0, 3);
+    std::uniform_int_distribution<int> blocked(0, 50);
+    unsigned long now = 0;
+    int refreshes = 0;
+    double lastOutput = 0;
+    while (refreshes < 500)
+    {
+        module.sampleDevices(now);
+        if (module.refreshIfDue(now))
+        {
+            double output = readField(module.getDataStream());
+            if (refreshes > 0)
+            {
+                TEST_ASSERT_EQUAL_DOUBLE(lastOutput + 10, output);
+            }
+            lastOutput = output;
+            refreshes++;
+        }
+
+        unsigned long nextSampleTime;
+        TEST_ASSERT_TRUE(module.getNextSampleTime(now, nextSampleTime));
+        unsigned long deadline = std::min(nextSampleTime, module.getNextRefreshTime());
+        now = std::max(now, deadline + jitter(random) + (blocked(random) == 0 ? 60 : 0));
+    }
+
+    // A long stall skips the samples and refreshes it missed, then the
+    // schedule carries on from where it was.
+    now = module.getNextRefreshTime() + 5250;
+    module.sampleDevices(now);
+    TEST_ASSERT_TRUE(module.refreshIfDue(now));
+    TEST_ASSERT_EQUAL(now - 250 + 1000, module.getNextRefreshTime());
+    unsigned long nextSampleTime;
+    TEST_ASSERT_TRUE(module.getNextSampleTime(now, nextSampleTime));
+    TEST_ASSERT_EQUAL(now - 50 + 100, nextSampleTime);
+    delete device;
+}
+
+// Returns the mean time process() takes per input sample.
+double benchmarkFilter(CubeSatFilter& filter)
+{
+    std::vector<int32_t> input(1 << 20);
+    for (size_t i = 0; i < input.size(); i++)
+    {
+        input[i] = static_cast<int32_t>(i * 7919 % 200000) - 100000;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<int32_t> output = runFilter(filter, input);
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    TEST_ASSERT_GREATER_THAN(0, output.size());
+    return elapsed.count() / input.size();
+}
+
+void test_process_time_per_sample()
+{
+    CubeSatCicFilter cic(8, 3);
+    CubeSatFirFilter fir(4, 15, 0.1);
+    double cicTime = benchmarkFilter(cic);
+    double firTime = benchmarkFilter(fir);
+    TEST_MESSAGE(("CIC(8, 3) " + std::to_string(cicTime) + " ns/sample").c_str());
+    TEST_MESSAGE(("FIR(4, 15, 0.1) " + std::to_string(firTime) + " ns/sample").c_str());
+
+    // Generous bounds that only catch gross regressions on the host.
+    TEST_ASSERT_LESS_THAN_DOUBLE(1000.0, cicTime);
+    TEST_ASSERT_LESS_THAN_DOUBLE(1000.0, firTime);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_cic_dc_gain_is_unity);
+    RUN_TEST(test_fir_dc_gain_is_unity);
+    RUN_TEST(test_cic_stopband_attenuation);
+    RUN_TEST(test_fir_stopband_attenuation);
+    RUN_TEST(test_cic_integrators_wrap);
+    RUN_TEST(test_stage_saturates_large_readings);
+    RUN_TEST(test_one_output_per_refresh);
+    RUN_TEST(test_process_time_per_sample);
+    return UNITY_END();
+}
@@ -0,0 +1,533 @@
+// test_flight_log.cpp
+
+/******************************************************************************
+    Flight Log Tests
+
+    Purpose:
+        Exercises the indexed flight log and serial exporter against an
+        in-memory stand-in for the SD card. Covers index spacing, recovery
+        from a torn or lagging index, short log and index writes, sequence
+        and time export ranges across reboots, device selection, framed
+        statistics responses and export throughput.
+******************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include <unity.h>
+#include "CubeSat/Logging/CubeSatFlightLog.h"
+#include "CubeSat/Logging/CubeSatLogExporter.h"
+
+static const char* LOG_PATH = "/CubeSatLog.txt";
+static const char* INDEX_PATH = "/CubeSatLog.idx";
+
+// Index interval small enough to give many entries in a short log.
+static constexpr uint32_t TEST_INDEX_INTERVAL = 256;
+
+// Serial export speed in bytes per second (921600 baud, 10 bits a byte).
+static constexpr double SERIAL_BYTES_PER_SECOND = 92160.0;
+
+// File held in a string owned by the storage. Writes stop short once
+// writeLimit bytes have been written, if it is set.
+class MemoryLogFile : public CubeSatLogFile
+{
+    public:
+        MemoryLogFile(std::string& data, size_t* writeLimit) : data(data), writeLimit(writeLimit) {}
+
+        uint32_t size() override { return data.size(); }
+
+        bool seek(uint32_t position) override
+        {
+            if (position > data.size())
+            {
+                return false;
+            }
+            this->position = position;
+            return true;
+        }
+
+        size_t read(uint8_t* buffer, size_t length) override
+        {
+            size_t count = data.copy(reinterpret_cast<char*>(buffer), length, position);
+            position += count;
+            return count;
+        }
+
+        size_t write(const uint8_t* buffer, size_t length) override
+        {
+            if (writeLimit)
+            {
+                length = std::min(length, *writeLimit);
+                *writeLimit -= length;
+            }
+            data.append(reinterpret_cast<const char*>(buffer), length);
+            return length;
+        }
+
+        void flush() override {}
+
+    private:
+        std::string& data;
+        size_t* writeLimit;
+        size_t position = 0;
+};
+
+// Storage keeping every file in memory. Files opened for a path in
+// writeLimits share its limit on further writes, as on a failing card.
+class MemoryLogStorage : public CubeSatLogStorage
+{
+    public:
+        CubeSatLogFile* open(const char* path, bool append) override
+        {
+            if (!append && files.find(path) == files.end())
+            {
+                return nullptr;
+            }
+            std::map<std::string, size_t>::iterator limit = writeLimits.find(path);
+            return new MemoryLogFile(files[path], limit == writeLimits.end() ? nullptr : &limit->second);
+        }
+
+        bool remove(const char* path) override
+        {
+            files.erase(path);
+            return true;
+        }
+
+        std::map<std::string, std::string> files;
+        std::map<std::string, size_t> writeLimits;
+};
+
+// Sink collecting exported data.
+class StringLogSink : public CubeSatLogSink
+{
+    public:
+        size_t write(const uint8_t* buffer, size_t length) override
+        {
+            output.append(reinterpret_cast<const char*>(buffer), length);
+            return length;
+        }
+
+        std::string output;
+};
+
+MemoryLogStorage* storage;
+
+void setUp()
+{
+    storage = new MemoryLogStorage();
+}
+
+void tearDown()
+{
+    delete storage;
+}
+
+// Returns a data stream with two devices from one of three modules.
+std::string makeFrame(uint32_t sequence)
+{
+    return std::to_string(sequence % 3) + ":1.25,2.50,"
+        + std::to_string(sequence) + ":" + std::to_string(sequence * 7) + ":;";
+}
+
+// Appends records one refresh interval apart, starting at time zero as
+// after a reboot.
+void appendRecords(CubeSatFlightLog& log, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        TEST_ASSERT_TRUE(log.append(i * 1000, makeFrame(log.getNextSequence())));
+    }
+}
+
+// Opens the log as a new boot would and appends records to it.
+void writeBoot(uint32_t count)
+{
+    CubeSatFlightLog log(storage, LOG_PATH, INDEX_PATH, TEST_INDEX_INTERVAL);
+    TEST_ASSERT_TRUE(log.begin());
+    appendRecords(log, count);
+    log.flush();
+}
+
+// Decodes every entry of the index file.
+std::vector<CubeSatLogIndexEntry> readIndex()
+{
+    const std::string& index = storage->files[INDEX_PATH];
+    std::vector<CubeSatLogIndexEntry> entries;
+    for (size_t offset = 0; offset + CubeSatLogIndexEntry::ENCODED_SIZE <= index.size();
+        offset += CubeSatLogIndexEntry::ENCODED_SIZE)
+    {
+        entries.push_back(CubeSatLogIndexEntry::decode(
+            reinterpret_cast<const uint8_t*>(index.data() + offset)));
+    }
+    return entries;
+}
+
+// Runs an export command and returns the records between BEGIN and END,
+// checking the trailer against them.
+std::vector<CubeSatLogRecord> runExport(CubeSatFlightLog& log, const std::string& command,
+    std::string& output)
+{
+    StringLogSink sink;
+    CubeSatLogExporter exporter(&log, &sink);
+    TEST_ASSERT_TRUE(exporter.handleCommand(command));
+    output = sink.output;
+
+    const std::string begin = "BEGIN\n";
+    TEST_ASSERT_EQUAL(0, output.compare(0, begin.size(), begin));
+    size_t trailer = output.rfind("END ");
+    TEST_ASSERT_TRUE(trailer != std::string::npos);
+
+    std::vector<CubeSatLogRecord> records;
+    size_t position = begin.size();
+    while (position < trailer)
+    {
+        size_t terminator = output.find(CubeSatFlightLog::RECORD_TERMINATOR, position);
+        CubeSatLogRecord record;
+        TEST_ASSERT_TRUE(CubeSatFlightLog::parseRecord(output.data() + position,
+            terminator - position, record));
+        records.push_back(record);
+        position = terminator + 1;
+    }
+
+    std::string expectedTrailer = "END " + std::to_string(records.size()) + " "
+        + std::to_string(trailer - begin.size()) + "\n";
+    TEST_ASSERT_EQUAL_STRING(expectedTrailer.c_str(), output.c_str() + trailer);
+    return records;
+}
+
+void test_index_entries_are_spaced_by_interval()
+{
+    writeBoot(500);
+
+    const std::string& logData = storage->files[LOG_PATH];
+    std::vector<CubeSatLogIndexEntry> entries = readIndex();
+    TEST_ASSERT_GREATER_THAN(1, entries.size());
+    TEST_ASSERT_EQUAL(0, entries[0].offset);
+    TEST_ASSERT_EQUAL(0, entries[0].sequence);
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        // Each entry points at the start of the record it describes.
+        CubeSatLogRecord record;
+        size_t terminator = logData.find(CubeSatFlightLog::RECORD_TERMINATOR, entries[i].offset);
+        TEST_ASSERT_TRUE(entries[i].offset == 0 || logData[entries[i].offset - 1] == '\n');
+        TEST_ASSERT_TRUE(CubeSatFlightLog::parseRecord(logData.data() + entries[i].offset,
+            terminator - entries[i].offset, record));
+        TEST_ASSERT_EQUAL(record.sequence, entries[i].sequence);
+        TEST_ASSERT_EQUAL(record.timestamp, entries[i].timestamp);
+
+        // Entries are the first record at least an interval past the
+        // previous one.
+        if (i > 0)
+        {
+            uint32_t gap = entries[i].offset - entries[i - 1].offset;
+            size_t previousRecord = logData.rfind('\n', entries[i].offset - 2);
+            TEST_ASSERT_GREATER_OR_EQUAL(TEST_INDEX_INTERVAL, gap);
+            TEST_ASSERT_LESS_THAN(TEST_INDEX_INTERVAL, previousRecord + 1 - entries[i - 1].offset);
+        }
+    }
+}
+
+void test_torn_index_is_rebuilt()
+{
+    writeBoot(500);
+    std::string expectedIndex = storage->files[INDEX_PATH];
+
+    // Lose part of the last entry, as a reset mid-write would.
+    storage->files[INDEX_PATH].resize(expectedIndex.size() - 5);
+
+    CubeSatFlightLog log(storage, LOG_PATH, INDEX_PATH, TEST_INDEX_INTERVAL);
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_EQUAL(500, log.getNextSequence());
+    TEST_ASSERT_EQUAL(expectedIndex.size() / CubeSatLogIndexEntry::ENCODED_SIZE,
+        log.getIndexEntryCount());
+    TEST_ASSERT_TRUE(storage->files[INDEX_PATH] == expectedIndex);
+}
+
+void test_missing_index_is_rebuilt()
+{
+    writeBoot(500);
+    std::string expectedIndex = storage->files[INDEX_PATH];
+    storage->remove(INDEX_PATH);
+
+    CubeSatFlightLog log(storage, LOG_PATH, INDEX_PATH, TEST_INDEX_INTERVAL);
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_EQUAL(500, log.getNextSequence());
+    TEST_ASSERT_TRUE(storage->files[INDEX_PATH] == expectedIndex);
+}
+
+void test_lagging_index_resumes_from_last_entry()
+{
+    writeBoot(500);
+    std::string expectedIndex = storage->files[INDEX_PATH];
+
+    // Drop whole entries, as if the index was not flushed before a reset.
+    storage->files[INDEX_PATH].resize(3 * CubeSatLogIndexEntry::ENCODED_SIZE);
+
+    CubeSatFlightLog log(storage, LOG_PATH, INDEX_PATH, TEST_INDEX_INTERVAL);
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_EQUAL(500, log.getNextSequence());
+    TEST_ASSERT_EQUAL(1, log.getBoot());
+    TEST_ASSERT_TRUE(storage->files[INDEX_PATH] == expectedIndex);
+
+    // Appending carries on the sequence in the new boot.
+    TEST_ASSERT_TRUE(log.append(0, makeFrame(500)));
+    std::string output;
+    std::vector<CubeSatLogRecord> records = runExport(log, "EXPORT SEQ 499 500", output);
+    TEST_ASSERT_EQUAL(2, records.size());
+    TEST_ASSERT_EQUAL(0, records[0].boot);
+    TEST_ASSERT_EQUAL(1, records[1].boot);
+    TEST_ASSERT_EQUAL(500, records[1].sequence);
+}
+
+void test_short_write_is_terminated()
+{
+    storage->writeLimits[LOG_PATH] = SIZE_MAX;
+    CubeSatFlightLog log(storage, LOG_PATH, INDEX_PATH, TEST_INDEX_INTERVAL);
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_TRUE(log.append(0, makeFrame(0)));
+
+    // Tear the next record part way through its frame.
+    storage->writeLimits[LOG_PATH] = 10;
+    TEST_ASSERT_FALSE(log.append(1000, makeFrame(1)));
+    storage->writeLimits[LOG_PATH] = SIZE_MAX;
+    TEST_ASSERT_EQUAL(2, log.getNextSequence());
+    TEST_ASSERT_TRUE(log.append(2000, makeFrame(2)));
+
+    // Tear another with no room left to end it, so it is ended by the
+    // next append instead.
+    storage->writeLimits[LOG_PATH] = 12;
+    TEST_ASSERT_FALSE(log.append(3000, makeFrame(3)));
+    TEST_ASSERT_FALSE(log.append(4000, makeFrame(4)));
+    storage->writeLimits[LOG_PATH] = SIZE_MAX;
+    TEST_ASSERT_TRUE(log.append(5000, makeFrame(4)));
+    TEST_ASSERT_EQUAL(storage->files[LOG_PATH].size(), log.getLogSize());
+
+    // Torn records keep their own sequence number and timestamp and the
+    // records after them are intact.
+    std::string output;
+    std::vector<CubeSatLogRecord> records = runExport(log, "EXPORT SEQ 0 10", output);
+    TEST_ASSERT_EQUAL(5, records.size());
+    const uint32_t timestamps[] = { 0, 1000, 2000, 3000, 5000 };
+    for (uint32_t i = 0; i < records.size(); i++)
+    {
+        TEST_ASSERT_EQUAL(i, records[i].sequence);
+        TEST_ASSERT_EQUAL(timestamps[i], records[i].timestamp);
+    }
+    TEST_ASSERT_TRUE(std::string(records[2].frame, records[2].frameLength) == makeFrame(2));
+    TEST_ASSERT_TRUE(std::string(records[4].frame, records[4].frameLength) == makeFrame(4));
+
+    // Time ranges run past the torn records.
+    records = runExport(log, "EXPORT TIME 0 2000 5000", output);
+    TEST_ASSERT_EQUAL(3, records.size());
+
+    // Reopening finds nothing to repair.
+    uint32_t logSize = log.getLogSize();
+    CubeSatFlightLog reopened(storage, LOG_PATH, INDEX_PATH, TEST_INDEX_INTERVAL);
+    TEST_ASSERT_TRUE(reopened.begin());
+    TEST_ASSERT_EQUAL(5, reopened.getNextSequence());
+    TEST_ASSERT_EQUAL(logSize, reopened.getLogSize());
+}
+
+void test_short_index_write_stops_indexing()
+{
+    writeBoot(500);
+    std::string expectedIndex = storage->files[INDEX_PATH];
+    storage->files.clear();
+
+    // Tear the third index entry.
+    storage->writeLimits[INDEX_PATH] = 2 * CubeSatLogIndexEntry::ENCODED_SIZE + 5;
+    CubeSatFlightLog log(storage, LOG_PATH, INDEX_PATH, TEST_INDEX_INTERVAL);
+    TEST_ASSERT_TRUE(log.begin());
+    for (uint32_t i = 0; i < 500; i++)
+    {
+        // Entries written once the card recovers would be misaligned.
+        if (i == 250)
+        {
+            storage->writeLimits[INDEX_PATH] = SIZE_MAX;
+        }
+        TEST_ASSERT_TRUE(log.append(i * 1000, makeFrame(i)));
+    }
+    TEST_ASSERT_EQUAL(2, log.getIndexEntryCount());
+    TEST_ASSERT_EQUAL(2 * CubeSatLogIndexEntry::ENCODED_SIZE + 5, storage->files[INDEX_PATH].size());
+
+    // Exports fall back to reading from the start of the log.
+    std::string output;
+    std::vector<CubeSatLogRecord> records = runExport(log, "EXPORT SEQ 120 179", output);
+    TEST_ASSERT_EQUAL(60, records.size());
+    TEST_ASSERT_EQUAL(120, records[0].sequence);
+
+    // The index is rebuilt when the log is next opened.
+    storage->writeLimits.clear();
+    CubeSatFlightLog reopened(storage, LOG_PATH, INDEX_PATH, TEST_INDEX_INTERVAL);
+    TEST_ASSERT_TRUE(reopened.begin());
+    TEST_ASSERT_EQUAL(500, reopened.getNextSequence());
+    TEST_ASSERT_TRUE(storage->files[INDEX_PATH] == expectedIndex);
+}
+
+void test_export_sequence_range()
+{
+    writeBoot(500);
+    CubeSatFlightLog log(storage, LOG_PATH, INDEX_PATH, TEST_INDEX_INTERVAL);
+    TEST_ASSERT_TRUE(log.begin());
+
+    std::string output;
+    std::vector<CubeSatLogRecord> records = runExport(log, "EXPORT SEQ 120 179", output);
+    TEST_ASSERT_EQUAL(60, records.size());
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        TEST_ASSERT_EQUAL(120 + i, records[i].sequence);
+        TEST_ASSERT_TRUE(std::string(records[i].frame, records[i].frameLength) == makeFrame(120 + i));
+    }
+
+    records = runExport(log, "EXPORT SEQ 0 1000000", output);
+    TEST_ASSERT_EQUAL(500, records.size());
+    TEST_ASSERT_EQUAL(0, records.front().sequence);
+    TEST_ASSERT_EQUAL(499, records.back().sequence);
+}
+
+void test_export_time_range_selects_boot()
+{
+    // Every boot restarts its timestamps at zero.
+    writeBoot(300);
+    writeBoot(300);
+    writeBoot(300);
+    CubeSatFlightLog log(storage, LOG_PATH, INDEX_PATH, TEST_INDEX_INTERVAL);
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_EQUAL(3, log.getBoot());
+
+    for (uint32_t boot = 0; boot < 3; boot++)
+    {
+        std::string command = "EXPORT TIME " + std::to_string(boot) + " 100000 149500";
+        std::string output;
+        std::vector<CubeSatLogRecord> records = runExport(log, command, output);
+        TEST_ASSERT_EQUAL(50, records.size());
+        for (size_t i = 0; i < records.size(); i++)
+        {
+            TEST_ASSERT_EQUAL(boot, records[i].boot);
+            TEST_ASSERT_EQUAL(100000 + i * 1000, records[i].timestamp);
+            TEST_ASSERT_EQUAL(boot * 300 + 100 + i, records[i].sequence);
+        }
+    }
+
+    // A range running past the end of a boot stops at the next boot.
+    std::string output;
+    std::vector<CubeSatLogRecord> records = runExport(log, "EXPORT TIME 1 290000 4000000000", output);
+    TEST_ASSERT_EQUAL(10, records.size());
+    TEST_ASSERT_EQUAL(599, records.back().sequence);
+}
+
+void test_export_device()
+{
+    writeBoot(300);
+    writeBoot(300);
+    CubeSatFlightLog log(storage, LOG_PATH, INDEX_PATH, TEST_INDEX_INTERVAL);
+    TEST_ASSERT_TRUE(log.begin());
+
+    // Statistics records and traced frames short of the device are skipped.
+    TEST_ASSERT_TRUE(log.append(0, "WAKEUP,0,0,500,0,0,0,0,0"));
+    TEST_ASSERT_TRUE(log.append(1000, "2:9.5:@4000000,120;"));
+    TEST_ASSERT_TRUE(log.append(2000, "2:9.5:81:@4000000,120,80;"));
+
+    std::string output;
+    std::vector<CubeSatLogRecord> records = runExport(log, "EXPORT DEVICE 1", output);
+    TEST_ASSERT_EQUAL(601, records.size());
+    for (uint32_t i = 0; i < 600; i++)
+    {
+        std::string frame = std::to_string(i % 3) + ":" + std::to_string(i * 7) + ":;";
+        TEST_ASSERT_EQUAL(i, records[i].sequence);
+        TEST_ASSERT_EQUAL_STRING(frame.c_str(), std::string(records[i].frame, records[i].frameLength).c_str());
+    }
+    TEST_ASSERT_EQUAL_STRING("2:81:;", std::string(records[600].frame, records[600].frameLength).c_str());
+
+    records = runExport(log, "EXPORT DEVICE 0", output);
+    TEST_ASSERT_EQUAL(602, records.size());
+    TEST_ASSERT_EQUAL_STRING("0:1.25,2.50,0:;", std::string(records[0].frame, records[0].frameLength).c_str());
+    TEST_ASSERT_EQUAL_STRING("2:9.5:;", std::string(records[600].frame, records[600].frameLength).c_str());
+
+    records = runExport(log, "EXPORT DEVICE 2", output);
+    TEST_ASSERT_EQUAL(0, records.size());
+
+    // Ranges can be cut down to a device too.
+    records = runExport(log, "EXPORT SEQ 10 20 1", output);
+    TEST_ASSERT_EQUAL(11, records.size());
+    TEST_ASSERT_EQUAL_STRING("1:70:;", std::string(records[0].frame, records[0].frameLength).c_str());
+    records = runExport(log, "EXPORT TIME 1 0 9000 0", output);
+    TEST_ASSERT_EQUAL(10, records.size());
+    TEST_ASSERT_EQUAL(300, records[0].sequence);
+}
+
+void test_rejects_malformed_commands()
+{
+    writeBoot(10);
+    CubeSatFlightLog log(storage, LOG_PATH, INDEX_PATH, TEST_INDEX_INTERVAL);
+    TEST_ASSERT_TRUE(log.begin());
+    StringLogSink sink;
+    CubeSatLogExporter exporter(&log, &sink);
+
+    const char* commands[] = { "EXPORT", "EXPORT TIME 0 100", "EXPORT SEQ 9 1",
+        "EXPORT TIME x 0 100", "EXPORT DEVICE one", "EXPORT MODULE 1", "EXPORT SEQ 0 9 x",
+        "IMPORT ALL" };
+    for (const char* command : commands)
+    {
+        sink.output.clear();
+        TEST_ASSERT_FALSE(exporter.handleCommand(command));
+        TEST_ASSERT_EQUAL(0, sink.output.compare(0, 4, "ERR "));
+    }
+}
+
+void test_send_lines_is_framed_like_an_export()
+{
+    CubeSatFlightLog log(storage, LOG_PATH, INDEX_PATH, TEST_INDEX_INTERVAL);
+    StringLogSink sink;
+    CubeSatLogExporter exporter(&log, &sink);
+
+    exporter.sendLines({ "POWER,1,2,3,4", "WAKEUP,0,0,500,10,20,30,40,50" });
+    TEST_ASSERT_EQUAL_STRING("BEGIN\nPOWER,1,2,3,4\nWAKEUP,0,0,500,10,20,30,40,50\nEND 2 44\n",
+        sink.output.c_str());
+
+    sink.output.clear();
+    exporter.sendLines({});
+    TEST_ASSERT_EQUAL_STRING("BEGIN\nEND 0 0\n", sink.output.c_str());
+}
+
+void test_export_throughput()
+{
+    writeBoot(50000);
+    CubeSatFlightLog log(storage, LOG_PATH, INDEX_PATH);
+    TEST_ASSERT_TRUE(log.begin());
+
+    StringLogSink sink;
+    CubeSatLogExporter exporter(&log, &sink);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    TEST_ASSERT_TRUE(exporter.handleCommand("EXPORT ALL"));
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double bytesPerSecond = sink.output.size() / elapsed.count();
+    std::string message = std::to_string(sink.output.size()) + " bytes at "
+        + std::to_string(static_cast<uint64_t>(bytesPerSecond)) + " bytes/s";
+    TEST_MESSAGE(message.c_str());
+
+    // Exporting must not be the bottleneck behind the serial link.
+    TEST_ASSERT_GREATER_THAN_DOUBLE(10 * SERIAL_BYTES_PER_SECOND, bytesPerSecond);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_index_entries_are_spaced_by_interval);
+    RUN_TEST(test_torn_index_is_rebuilt);
+    RUN_TEST(test_missing_index_is_rebuilt);
+    RUN_TEST(test_lagging_index_resumes_from_last_entry);
+    RUN_TEST(test_short_write_is_terminated);
+    RUN_TEST(test_short_index_write_stops_indexing);
+    RUN_TEST(test_export_sequence_range);
+    RUN_TEST(test_export_time_range_selects_boot);
+    RUN_TEST(test_export_device);
+    RUN_TEST(test_rejects_malformed_commands);
+    RUN_TEST(test_send_lines_is_framed_like_an_export);
+    RUN_TEST(test_export_throughput);
+    return UNITY_END();
+}
@@ -0,0 +1,234 @@
+// test_timing.cpp
+
+/******************************************************************************
+    Timing Tests
+
+    Purpose:
+        Exercises the latency tracing pieces against a simulated clock:
+        clock synchronization under offset, skew and wraparound, frame
+        trace encode/parse round trips and rolling latency percentiles.
+******************************************************************************/
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <unity.h>
+#include "CubeSat/Timing/CubeSatClock.h"
+#include "CubeSat/Timing/CubeSatClockSync.h"
+#include "CubeSat/Timing/CubeSatFrameTrace.h"
+#include "CubeSat/Timing/CubeSatLatencyStats.h"
+
+// Minimum module to hub transit delay, in microseconds.
+static constexpr double MIN_TRANSIT = 300.0;
+
+// Mean queueing delay added on top of the minimum, in microseconds.
+static constexpr double MEAN_QUEUEING = 2000.0;
+
+// Frames observed before the estimate is expected to have settled.
+static constexpr int WARMUP_FRAMES = 8 * CubeSatClockSync::WINDOW_SIZE;
+
+// Clock running at a fixed rate and offset from true time, wrapping at
+// 2^32 microseconds like micros() does.
+class SimulatedClock : public CubeSatClock
+{
+    public:
+        SimulatedClock(double rate, double offset) : rate(rate), offset(offset) {}
+
+        uint32_t micros() override
+        {
+            return static_cast<uint32_t>(static_cast<uint64_t>(now * rate + offset));
+        }
+
+        // True time in microseconds.
+        double now = 0;
+
+    private:
+        double rate;
+        double offset;
+};
+
+struct LinkResult
+{
+    double worstError = 0;
+    double skew = 0;
+    bool moduleWrapped = false;
+    bool hubWrapped = false;
+};
+
+void setUp() {}
+
+void tearDown() {}
+
+// Sends a frame a second from a module to the hub and checks how well
+// the hub recovers each frame's queueing delay from the module's encode
+// time. skew is how much faster the module clock runs, in ppm.
+LinkResult simulateLink(double skew, double moduleOffset, double hubOffset, int frameCount)
+{
+    SimulatedClock moduleClock(1.0 + skew * 1e-6, moduleOffset);
+    SimulatedClock hubClock(1.0, hubOffset);
+    CubeSatClockSync clockSync;
+    std::mt19937 random(1);
+    std::exponential_distribution<double> queueing(1.0 / MEAN_QUEUEING);
+
+    LinkResult result;
+    uint32_t lastModuleTime = moduleClock.micros();
+    uint32_t lastHubTime = hubClock.micros();
+    for (int frame = 0; frame < frameCount; frame++)
+    {
+        double queueDelay = queueing(random);
+        moduleClock.now = frame * 1e6;
+        hubClock.now = moduleClock.now + MIN_TRANSIT + queueDelay;
+
+        uint32_t encodeTime = moduleClock.micros();
+        uint32_t ingestTime = hubClock.micros();
+        result.moduleWrapped |= encodeTime < lastModuleTime;
+        result.hubWrapped |= ingestTime < lastHubTime;
+        lastModuleTime = encodeTime;
+        lastHubTime = ingestTime;
+
+        clockSync.observe(encodeTime, ingestTime);
+        TEST_ASSERT_TRUE(clockSync.isSynchronized());
+
+        // The minimum transit delay is indistinguishable from clock
+        // offset, so only the queueing delay is measurable.
+        int32_t measuredDelay = static_cast<int32_t>(ingestTime - clockSync.toHubTime(encodeTime));
+        if (frame >= WARMUP_FRAMES)
+        {
+            result.worstError = std::max(result.worstError, std::fabs(measuredDelay - queueDelay));
+        }
+    }
+    result.skew = clockSync.getSkew();
+    return result;
+}
+
+void test_clock_sync_recovers_offset()
+{
+    LinkResult result = simulateLink(0.0, 12345678.0, 1000.0, 2000);
+    TEST_ASSERT_DOUBLE_WITHIN(0.5, 0.0, result.skew);
+    TEST_ASSERT_LESS_THAN_DOUBLE(150.0, result.worstError);
+}
+
+void test_clock_sync_tracks_skew()
+{
+    // The hub sees a fast module's delta shrink by its skew.
+    for (double skew : { -80.0, 50.0 })
+    {
+        LinkResult result = simulateLink(skew, 5.0e8, 0.0, 2000);
+        TEST_ASSERT_DOUBLE_WITHIN(2.0, -skew, result.skew);
+        TEST_ASSERT_LESS_THAN_DOUBLE(150.0, result.worstError);
+    }
+}
+
+void test_clock_sync_survives_wraparound()
+{
+    // Both clocks wrap within the run, at different times.
+    LinkResult result = simulateLink(50.0, 4.0e9, 3.0e9, 3000);
+    TEST_ASSERT_TRUE(result.moduleWrapped);
+    TEST_ASSERT_TRUE(result.hubWrapped);
+    TEST_ASSERT_DOUBLE_WITHIN(2.0, -50.0, result.skew);
+    TEST_ASSERT_LESS_THAN_DOUBLE(150.0, result.worstError);
+}
+
+void test_clock_sync_before_first_window()
+{
+    CubeSatClockSync clockSync;
+    TEST_ASSERT_FALSE(clockSync.isSynchronized());
+
+    clockSync.observe(1000, 6000);
+    clockSync.observe(2000, 6500);
+    TEST_ASSERT_TRUE(clockSync.isSynchronized());
+    TEST_ASSERT_EQUAL_UINT32(7500, clockSync.toHubTime(3000));
+}
+
+// Checks a trace survives being encoded into a data stream and parsed.
+void checkRoundTrip(const CubeSatFrameTrace& trace)
+{
+    std::string dataStream = "7:21.500000,1013.250000,40.000000:" + trace.encode() + ";";
+    CubeSatFrameTrace parsed;
+    TEST_ASSERT_TRUE(CubeSatFrameTrace::parse(dataStream, parsed));
+    TEST_ASSERT_EQUAL_UINT32(trace.encodeTime, parsed.encodeTime);
+    TEST_ASSERT_EQUAL(trace.captureAges.size(), parsed.captureAges.size());
+    for (size_t i = 0; i < trace.captureAges.size(); i++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(trace.captureAges[i], parsed.captureAges[i]);
+    }
+    TEST_ASSERT_EQUAL(trace.hasHubStages, parsed.hasHubStages);
+    if (trace.hasHubStages)
+    {
+        TEST_ASSERT_EQUAL_UINT32(trace.ingestDelay, parsed.ingestDelay);
+        TEST_ASSERT_EQUAL_UINT32(trace.transmitDelay, parsed.transmitDelay);
+    }
+    TEST_ASSERT_EQUAL(dataStream.find('@'), CubeSatFrameTrace::find(dataStream));
+}
+
+void test_frame_trace_round_trip()
+{
+    CubeSatFrameTrace trace;
+    trace.encodeTime = 4294967295u;
+    checkRoundTrip(trace);
+
+    trace.captureAges = { 0, 125000, 4294967295u };
+    checkRoundTrip(trace);
+
+    trace.hasHubStages = true;
+    trace.ingestDelay = 2300;
+    trace.transmitDelay = 0;
+    checkRoundTrip(trace);
+}
+
+void test_frame_trace_rejects_malformed()
+{
+    CubeSatFrameTrace trace;
+    const char* dataStreams[] = { "7:1.0,2.0:;", "7:1.0:@;", "7:1.0:@12,,3;", "7:1.0:@12,x;",
+        "7:1.0:@12/5;", "7:1.0:@12/5,6,7;", "7:1.0:@/5,6;" };
+    for (const char* dataStream : dataStreams)
+    {
+        TEST_ASSERT_FALSE(CubeSatFrameTrace::parse(dataStream, trace));
+    }
+}
+
+void test_latency_stats_percentiles()
+{
+    CubeSatLatencyStats stats;
+    TEST_ASSERT_EQUAL(0, stats.getCount());
+    TEST_ASSERT_EQUAL_UINT32(0, stats.percentile(50));
+
+    // Recorded out of order to exercise the selection.
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        stats.record((i * 37) % 100 + 1);
+    }
+    TEST_ASSERT_EQUAL(100, stats.getCount());
+    TEST_ASSERT_EQUAL_UINT32(1, stats.percentile(0));
+    TEST_ASSERT_EQUAL_UINT32(50, stats.percentile(50));
+    TEST_ASSERT_EQUAL_UINT32(90, stats.percentile(90));
+    TEST_ASSERT_EQUAL_UINT32(99, stats.percentile(99));
+    TEST_ASSERT_EQUAL_UINT32(100, stats.percentile(100));
+    TEST_ASSERT_EQUAL_STRING("100,50,90,99,100", stats.formatSummary().c_str());
+}
+
+void test_latency_stats_window_rolls()
+{
+    // Only the most recent window of samples counts.
+    CubeSatLatencyStats stats;
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        stats.record(i < 1000 - CubeSatLatencyStats::WINDOW_SIZE ? 1000000 : 10);
+    }
+    TEST_ASSERT_EQUAL(CubeSatLatencyStats::WINDOW_SIZE, stats.getCount());
+    TEST_ASSERT_EQUAL_UINT32(10, stats.percentile(100));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_clock_sync_recovers_offset);
+    RUN_TEST(test_clock_sync_tracks_skew);
+    RUN_TEST(test_clock_sync_survives_wraparound);
+    RUN_TEST(test_clock_sync_before_first_window);
+    RUN_TEST(test_frame_trace_round_trip);
+    RUN_TEST(test_frame_trace_rejects_malformed);
+    RUN_TEST(test_latency_stats_percentiles);
+    RUN_TEST(test_latency_stats_window_rolls);
+    return UNITY_END();
+}